@@ -0,0 +1,587 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+    Created: 20 Oct 2026 9:40:26am
+    Author:  regnier
+    Brief: Headless benchmarks, to track performance between releases outside of a DAW.
+    --> processBlock of IOSONOSourceControlAudioProcessor across sample rates, block sizes, channel counts,
+        AIR / DOPPLER combinations and distance automation patterns
+    --> AirAbsorption: scalar cutoffSolve, batch cutoffSolve, table lookup and cutoffApprox
+    --> AbsorptionFilter and gain: one channel at a time vs channels in SIMD lanes (interleaving included), 1 to 64 channels
+    --> DopplerDelay, each interpolator: process() on a delay ramp for 1, 2 and 8 channels, plain floats vs SIMD lanes,
+        and its error against the exact delayed sine
+    --> accuracy of cutoffApprox against cutoffSolve and AbsorptionCoefficient, exit code 1 if out of bounds
+    Results in ns/sample (ns/distance for the solver), written as JSON.
+
+    usage: IOSONOBenchmarks [--quick] [--seconds 2.0] [--output results.json]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        double seconds = 2.0;   // of audio per configuration
+        bool quick = false;
+        juce::File output;
+    };
+
+    Options parseOptions(const juce::StringArray& args)
+    {
+        Options options;
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            if (args[i] == "--quick")
+                options.quick = true;
+            else if (args[i] == "--seconds" && i + 1 < args.size())
+                options.seconds = juce::jmax(0.05, args[++i].getDoubleValue());
+            else if (args[i] == "--output" && i + 1 < args.size())
+                options.output = juce::File::getCurrentWorkingDirectory().getChildFile(args[++i]);
+        }
+
+        return options;
+    }
+
+    /* distance automation patterns, in meters, t and duration in seconds */
+    float distanceAt(const juce::String& pattern, double t, double duration)
+    {
+        if (pattern == "ramp")  return (float)juce::jmap(t / duration, 1.0, 300.0);                         // slow fly-by
+        if (pattern == "jump")  return std::fmod(t, 0.2) < 0.1 ? 5.0f : 150.0f;                              // worst case for the smoothers
+        if (pattern == "lfo")   return (float)(50.0 + 40.0 * std::sin(juce::MathConstants<double>::twoPi * 0.5 * t));
+        return 20.0f;                                                                                         // static
+    }
+
+    void setParameter(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = apvts.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    juce::var benchmarkProcessBlock(double sampleRate, int blockSize, int numChannels, bool air, bool doppler, const juce::String& pattern, double seconds)
+    {
+        IOSONOSourceControlAudioProcessor processor;
+
+        // stops the OSC sender thread, as for a bounce: nothing is sent and no network work competes with the timed blocks
+        processor.setNonRealtime(true);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        processor.setBusesLayout(layout);
+
+        setParameter(processor.apvts, "AIR", air ? 1.0f : 0.0f);
+        setParameter(processor.apvts, "DOPPLER", doppler ? 1.0f : 0.0f);
+        setParameter(processor.apvts, "DIST", distanceAt(pattern, 0.0, seconds));
+
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        // same noise block fed every time, generated outside of the timed section
+        juce::AudioBuffer<float> noise(numChannels, blockSize), buffer(numChannels, blockSize);
+        juce::Random random(1);
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                noise.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+        juce::MidiBuffer midi;
+        const auto numBlocks = juce::jmax(1, (int)(seconds * sampleRate / blockSize));
+        const auto warmupBlocks = juce::jmax(1, numBlocks / 10);
+
+        double totalNs = 0.0;
+        double worstBlockNs = 0.0;
+
+        for (int block = -warmupBlocks; block < numBlocks; ++block)
+        {
+            // automation comes from the host side, not timed
+            const auto t = juce::jmax(0, block) * blockSize / sampleRate;
+            if (pattern != "static")
+                setParameter(processor.apvts, "DIST", distanceAt(pattern, t, seconds));
+
+            buffer.makeCopyOf(noise, true);
+
+            const auto start = Clock::now();
+            processor.processBlock(buffer, midi);
+            const auto elapsedNs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+            if (block >= 0)
+            {
+                totalNs += elapsedNs;
+                worstBlockNs = juce::jmax(worstBlockNs, elapsedNs);
+            }
+        }
+
+        processor.releaseResources();
+
+        const auto numSamples = (double)numBlocks * blockSize;
+        const auto blockBudgetNs = blockSize / sampleRate * 1.0e9;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("sampleRate", sampleRate);
+        result->setProperty("blockSize", blockSize);
+        result->setProperty("channels", numChannels);
+        result->setProperty("air", air);
+        result->setProperty("doppler", doppler);
+        result->setProperty("distance", pattern);
+        result->setProperty("nsPerSample", totalNs / numSamples);
+        result->setProperty("worstBlockBudgetRatio", worstBlockNs / blockBudgetNs);
+        result->setProperty("realtimeFactor", numSamples / sampleRate * 1.0e9 / totalNs);
+        return juce::var(result);
+    }
+
+    /* runs f() repeatedly for about 0.2 s, returns ns per item */
+    template <typename Function>
+    double timePerItem(int itemsPerCall, Function&& f)
+    {
+        int calls = 0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+
+        do
+        {
+            f();
+            ++calls;
+            elapsed = Clock::now() - start;
+        }
+        while (elapsed < std::chrono::milliseconds(200));
+
+        return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / ((double)calls * itemsPerCall);
+    }
+
+    juce::var benchmarkAirAbsorption()
+    {
+        AirAbsorption air;
+        air.FilterCutoffSolver(50, 20, air.kPressureSeaLevelPascals);
+        air.buildCutoffTable(AirAbsorption::kDefaultCutoffGain);
+
+        // log-spaced over the DIST range
+        constexpr int numDistances = 4096;
+        std::vector<double> distances(numDistances), cutoffs(numDistances);
+        std::vector<float> floatDistances(numDistances);
+        for (int i = 0; i < numDistances; ++i)
+        {
+            distances[(size_t)i] = 0.1 * std::pow(3000.0, (double)i / (numDistances - 1));
+            floatDistances[(size_t)i] = (float)distances[(size_t)i];
+        }
+
+        volatile double sink = 0.0;
+
+        const auto scalarNs = timePerItem(numDistances, [&]
+            {
+                double sum = 0.0;
+                for (auto d : distances)
+                    sum += air.cutoffSolve(d, AirAbsorption::kDefaultCutoffGain);
+                sink = sum;
+            });
+
+        const auto batchNs = timePerItem(numDistances, [&]
+            {
+                air.cutoffSolve(distances.data(), cutoffs.data(), numDistances, AirAbsorption::kDefaultCutoffGain);
+                sink = cutoffs[0];
+            });
+
+        const auto lookupNs = timePerItem(numDistances, [&]
+            {
+                double sum = 0.0;
+                for (auto d : distances)
+                    sum += air.cutoffLookup(d);
+                sink = sum;
+            });
+
+        const auto approxNs = timePerItem(numDistances, [&]
+            {
+                float sum = 0.0f;
+                for (auto d : floatDistances)
+                    sum += air.cutoffApprox(d);
+                sink = sum;
+            });
+
+        juce::ignoreUnused(sink);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("scalarNsPerDistance", scalarNs);
+        result->setProperty("batchNsPerDistance", batchNs);
+        result->setProperty("lookupNsPerDistance", lookupNs);
+        result->setProperty("approxNsPerDistance", approxNs);
+        result->setProperty("batchSpeedup", scalarNs / batchNs);
+        return juce::var(result);
+    }
+
+    /* the filter and gain stage of the kernels, on a segment of numSamples: the scalar path (one channel at a time,
+       processSample) against the lane path (interleaved, laneWidth channels per register, as processLanes in the processor).
+       ns per channel and sample, and the largest difference between the two outputs */
+    juce::var benchmarkFilterLanes(int numChannels)
+    {
+        using Register = AbsorptionFilter::Register;
+        constexpr auto laneWidth = AbsorptionFilter::laneWidth;
+        constexpr int numSamples = 32;
+        const auto numGroups = (numChannels + laneWidth - 1) / laneWidth;
+
+        AbsorptionFilter scalarFilter, laneFilter;
+        scalarFilter.prepare({ 48000.0, (juce::uint32)numSamples, (juce::uint32)numChannels });
+        laneFilter.prepare({ 48000.0, (juce::uint32)numSamples, (juce::uint32)numChannels });
+
+        // ramps as updateSegmentCues would write them, and noise in
+        std::vector<float> coefficients(numSamples), gains(numSamples);
+        for (int n = 0; n < numSamples; ++n)
+        {
+            coefficients[(size_t)n] = 0.2f + 0.001f * (float)n;
+            gains[(size_t)n] = 0.5f - 0.002f * (float)n;
+        }
+
+        juce::Random random(1);
+        juce::AudioBuffer<float> input(numChannels, numSamples), scalarOutput(numChannels, numSamples), laneOutput(numChannels, numSamples);
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < numSamples; ++n)
+                input.setSample(channel, n, random.nextFloat() * 2.0f - 1.0f);
+
+        std::vector<Register> frames((size_t)(numSamples * numGroups), Register::expand(0.0f));
+        std::vector<Register> state((size_t)numGroups);
+
+        auto runScalar = [&]
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    const auto* in = input.getReadPointer(channel);
+                    auto* out = scalarOutput.getWritePointer(channel);
+
+                    for (int n = 0; n < numSamples; ++n)
+                        out[n] = gains[(size_t)n] * scalarFilter.processSample(channel, in[n], coefficients[(size_t)n]);
+                }
+            };
+
+        auto runLanes = [&]
+            {
+                auto* samples = reinterpret_cast<float*>(frames.data());
+                const auto stride = numGroups * laneWidth;
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    const auto* in = input.getReadPointer(channel);
+                    for (int n = 0; n < numSamples; ++n)
+                        samples[n * stride + channel] = in[n];
+                }
+
+                laneFilter.loadLanes(0, numChannels, state.data());
+
+                for (int n = 0; n < numSamples; ++n)
+                {
+                    const auto g = Register::expand(coefficients[(size_t)n]);
+                    const auto gain = Register::expand(gains[(size_t)n]);
+                    auto* frame = frames.data() + n * numGroups;
+
+                    for (int group = 0; group < numGroups; ++group)
+                        frame[group] = gain * AbsorptionFilter::processLanes(frame[group], g, state[(size_t)group]);
+                }
+
+                laneFilter.storeLanes(0, numChannels, state.data());
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    auto* out = laneOutput.getWritePointer(channel);
+                    for (int n = 0; n < numSamples; ++n)
+                        out[n] = samples[n * stride + channel];
+                }
+            };
+
+        const auto scalarNs = timePerItem(numChannels * numSamples, runScalar);
+        const auto laneNs = timePerItem(numChannels * numSamples, runLanes);
+
+        // one segment from a cleared state through each: the outputs must match
+        scalarFilter.reset();
+        laneFilter.reset();
+        runScalar();
+        runLanes();
+
+        auto maxDifference = 0.0f;
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int n = 0; n < numSamples; ++n)
+                maxDifference = juce::jmax(maxDifference, std::abs(scalarOutput.getSample(channel, n) - laneOutput.getSample(channel, n)));
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("channels", numChannels);
+        result->setProperty("laneWidth", laneWidth);
+        result->setProperty("scalarNsPerSample", scalarNs);
+        result->setProperty("laneNsPerSample", laneNs);
+        result->setProperty("laneSpeedup", scalarNs / laneNs);
+        result->setProperty("maxDifference", maxDifference);
+        return juce::var(result);
+    }
+
+    /* one DopplerDelay<> specialisation on a delay ramp (a source moving at about 17 m/s, back and forth, 200 to 300 samples):
+       - process() for 1, 2 and 8 channels, in ns per channel and sample, with plain floats and with the SIMD lanes
+         (nsPerSample is the path prepare() picks for that channel count)
+       - error against the exact delayed signal: a sine at frequency in, sin(w * (n - delay[n])) expected out,
+         RMS of the difference relative to the RMS of the sine, in dB, at 1 kHz and 10 kHz */
+    template <typename Interpolator>
+    juce::var benchmarkDopplerInterpolator(const juce::String& name)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 256;
+        constexpr int rampLength = 4096;    // one period of the ramp, a multiple of the block size
+        constexpr int maximumDelay = 512;
+
+        std::vector<float> delays(rampLength);
+        for (int n = 0; n < rampLength; ++n)
+            delays[(size_t)n] = 200.0f + 0.05f * (float)juce::jmin(n, rampLength - n);
+
+        juce::Array<juce::var> timings;
+
+        for (auto numChannels : { 1, 2, 8 })
+        {
+            juce::Random random(1);
+            juce::AudioBuffer<float> input(numChannels, blockSize), output(numChannels, blockSize);
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int n = 0; n < blockSize; ++n)
+                    input.setSample(channel, n, random.nextFloat() * 2.0f - 1.0f);
+
+            auto timeWith = [&](bool useLanes)
+                {
+                    DopplerDelay<Interpolator> delay;
+                    delay.prepare({ sampleRate, (juce::uint32)blockSize, (juce::uint32)numChannels }, maximumDelay);
+                    delay.setUseLanes(useLanes);
+
+                    int position = 0;
+                    return timePerItem(numChannels * blockSize, [&]
+                        {
+                            delay.process(input.getArrayOfReadPointers(), output.getArrayOfWritePointers(), blockSize, delays.data() + position);
+                            position = (position + blockSize) % rampLength;
+                        });
+                };
+
+            const auto scalarNs = timeWith(false);
+            const auto laneNs = timeWith(true);
+            const auto usesLanes = numChannels >= DopplerDelay<Interpolator>::laneWidth;
+
+            auto* timing = new juce::DynamicObject();
+            timing->setProperty("channels", numChannels);
+            timing->setProperty("nsPerSample", usesLanes ? laneNs : scalarNs);
+            timing->setProperty("scalarNsPerSample", scalarNs);
+            timing->setProperty("laneNsPerSample", laneNs);
+            timings.add(juce::var(timing));
+        }
+
+        auto errorDb = [&](double frequency)
+            {
+                DopplerDelay<Interpolator> delay;
+                delay.prepare({ sampleRate, (juce::uint32)blockSize, 1 }, maximumDelay);
+
+                const auto w = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+                std::vector<float> buffer(blockSize);
+                double errorEnergy = 0.0, signalEnergy = 0.0;
+
+                // one ramp to fill the line, two measured
+                for (int block = 0; block < 3 * rampLength / blockSize; ++block)
+                {
+                    const auto first = block * blockSize;
+                    for (int n = 0; n < blockSize; ++n)
+                        buffer[(size_t)n] = (float)std::sin(w * (first + n));
+
+                    auto* samples = buffer.data();
+                    const auto* ramp = delays.data() + first % rampLength;
+                    delay.process(&samples, &samples, blockSize, ramp);
+
+                    if (first < rampLength)
+                        continue;
+
+                    for (int n = 0; n < blockSize; ++n)
+                    {
+                        const auto expected = std::sin(w * (first + n - (double)ramp[n]));
+                        errorEnergy += juce::square(buffer[(size_t)n] - expected);
+                        signalEnergy += juce::square(expected);
+                    }
+                }
+
+                return 10.0 * std::log10(juce::jmax(1.0e-30, errorEnergy / signalEnergy));
+            };
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("interpolator", name);
+        result->setProperty("timings", timings);
+        result->setProperty("errorDb1k", errorDb(1000.0));
+        result->setProperty("errorDb10k", errorDb(10000.0));
+        return juce::var(result);
+    }
+
+    /* Accuracy of the fast paths over the DIST range and the HUMIDITY / TEMP / PRESSURE parameter ranges:
+       - relative cutoff error of cutoffApprox and cutoffLookup vs the exact cutoffSolve
+       - relative error of the attenuation at the approximated cutoff, from AbsorptionCoefficient, vs the target gain
+       passed is false when cutoffApprox or cutoffLookup exceeds its documented bound (AirAbsorption::kFastCutoffMaxError, kCutoffTableMaxError),
+       or when any of cutoffSolve, cutoffLookup and cutoffApprox is not finite anywhere on the grid (a NaN cutoff ends up in the filter state) */
+    juce::var checkCutoffApproximation(bool& passed)
+    {
+        constexpr int numDistances = 2000;
+        const auto gain = AirAbsorption::kDefaultCutoffGain;
+
+        double approxError = 0.0, lookupError = 0.0, attenuationError = 0.0;
+        juce::String worstAtmosphere, nonFiniteAtmosphere;
+        int numSkipped = 0, numNonFinite = 0;
+
+        for (auto humidity : { 0.0, 0.5, 1.0, 2.0, 5.0, 10.0, 20.0, 50.0, 75.0, 100.0 })
+            for (auto temperature : { -20.0, 0.0, 20.0, 35.0, 50.0 })
+                for (auto pressure : { 80000.0, 101325.0, 110000.0 })
+                {
+                    AirAbsorption air;
+                    air.FilterCutoffSolver(humidity, temperature, pressure);
+                    air.buildCutoffTable(gain);
+
+                    for (int i = 0; i < numDistances; ++i)
+                    {
+                        const auto distance = AirAbsorption::kCutoffTableMinDistance
+                            * std::pow(AirAbsorption::kCutoffTableMaxDistance / AirAbsorption::kCutoffTableMinDistance, (double)i / (numDistances - 1));
+                        const auto exact = air.cutoffSolve(distance, gain);
+                        const auto approx = (double)air.cutoffApprox((float)distance);
+                        const auto lookup = (double)air.cutoffLookup(distance);
+
+                        if (! std::isfinite(exact) || ! std::isfinite(approx) || ! std::isfinite(lookup))
+                        {
+                            ++numNonFinite;
+                            nonFiniteAtmosphere = juce::String(humidity) + " %, " + juce::String(temperature) + " C, " + juce::String(pressure) + " Pa";
+                            continue;
+                        }
+
+                        // above the cap the approximation is clamped on purpose
+                        if (exact > AirAbsorption::kFastCutoffMaxFrequency)
+                        {
+                            ++numSkipped;
+                            continue;
+                        }
+
+                        const auto error = std::abs(approx / exact - 1.0);
+
+                        if (error > approxError)
+                        {
+                            approxError = error;
+                            worstAtmosphere = juce::String(humidity) + " %, " + juce::String(temperature) + " C, " + juce::String(pressure) + " Pa";
+                        }
+
+                        lookupError = juce::jmax(lookupError, std::abs(lookup / exact - 1.0));
+
+                        const auto attenuation = air.AbsorptionCoefficient(approx, humidity, temperature, pressure) * distance;
+                        attenuationError = juce::jmax(attenuationError, std::abs(attenuation / gain - 1.0));
+                    }
+                }
+
+        passed = approxError <= AirAbsorption::kFastCutoffMaxError && lookupError <= AirAbsorption::kCutoffTableMaxError && numNonFinite == 0;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("approxMaxRelativeError", approxError);
+        result->setProperty("approxWorstAtmosphere", worstAtmosphere);
+        result->setProperty("approxMaxAttenuationError", attenuationError);
+        result->setProperty("lookupMaxRelativeError", lookupError);
+        result->setProperty("bound", AirAbsorption::kFastCutoffMaxError);
+        result->setProperty("lookupBound", AirAbsorption::kCutoffTableMaxError);
+        result->setProperty("skipped", numSkipped);
+        result->setProperty("nonFinite", numNonFinite);
+        result->setProperty("nonFiniteAtmosphere", nonFiniteAtmosphere);
+        result->setProperty("passed", passed);
+        return juce::var(result);
+    }
+
+    juce::var describeMachine()
+    {
+        auto* machine = new juce::DynamicObject();
+        machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+        machine->setProperty("numCpus", juce::SystemStats::getNumCpus());
+        machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+        machine->setProperty("juce", juce::SystemStats::getJUCEVersion());
+        machine->setProperty("dopplerInterpolation", IOSONO_DOPPLER_INTERPOLATION);
+       #if JUCE_DEBUG
+        machine->setProperty("build", "debug");
+       #else
+        machine->setProperty("build", "release");
+       #endif
+        return juce::var(machine);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    const auto options = parseOptions(args);
+
+    const juce::Array<double> sampleRates = options.quick ? juce::Array<double> { 48000.0 }
+                                                          : juce::Array<double> { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const juce::Array<int> blockSizes = options.quick ? juce::Array<int> { 64, 512 }
+                                                      : juce::Array<int> { 32, 64, 128, 256, 512, 1024, 2048 };
+    const juce::Array<int> channelCounts = options.quick ? juce::Array<int> { 1, 2 }
+                                                         : juce::Array<int> { 1, 2, 8 };
+    const juce::StringArray patterns { "static", "ramp", "jump", "lfo" };
+
+    juce::Array<juce::var> processBlockResults;
+
+    for (auto sampleRate : sampleRates)
+        for (auto blockSize : blockSizes)
+            for (auto numChannels : channelCounts)
+                for (int mode = 0; mode < 4; ++mode)
+                    for (auto& pattern : patterns)
+                    {
+                        const auto air = (mode & 1) != 0;
+                        const auto doppler = (mode & 2) != 0;
+                        auto result = benchmarkProcessBlock(sampleRate, blockSize, numChannels, air, doppler, pattern, options.seconds);
+
+                        std::cerr << sampleRate << " Hz, " << blockSize << " samples, " << numChannels << " ch, air " << air << ", doppler " << doppler
+                                  << ", " << pattern << ": " << (double)result["nsPerSample"] << " ns/sample" << std::endl;
+
+                        processBlockResults.add(result);
+                    }
+
+    auto* results = new juce::DynamicObject();
+    results->setProperty("machine", describeMachine());
+    results->setProperty("processBlock", processBlockResults);
+    results->setProperty("airAbsorption", benchmarkAirAbsorption());
+
+    juce::Array<juce::var> filterLaneResults;
+    for (auto numChannels : { 1, 2, 4, 8, 16, 64 })
+    {
+        auto result = benchmarkFilterLanes(numChannels);
+        std::cerr << "filter + gain, " << numChannels << " ch: " << (double)result["scalarNsPerSample"] << " ns/sample scalar, "
+                  << (double)result["laneNsPerSample"] << " ns/sample in lanes (x" << (double)result["laneSpeedup"] << ")" << std::endl;
+        filterLaneResults.add(result);
+    }
+
+    results->setProperty("filterLanes", filterLaneResults);
+
+    juce::Array<juce::var> dopplerResults {
+        benchmarkDopplerInterpolator<DopplerInterpolation::Linear>("linear"),
+        benchmarkDopplerInterpolator<DopplerInterpolation::Lagrange3rd>("lagrange3rd"),
+        benchmarkDopplerInterpolator<DopplerInterpolation::Thiran>("thiran"),
+        benchmarkDopplerInterpolator<DopplerInterpolation::WindowedSinc>("windowedSinc")
+    };
+
+    for (const auto& result : dopplerResults)
+    {
+        std::cerr << "doppler " << result["interpolator"].toString() << ":";
+        for (const auto& timing : *result["timings"].getArray())
+            std::cerr << " " << (int)timing["channels"] << " ch " << (double)timing["nsPerSample"] << " ns/sample,";
+        std::cerr << " error " << (double)result["errorDb1k"] << " dB at 1 kHz, " << (double)result["errorDb10k"] << " dB at 10 kHz" << std::endl;
+    }
+
+    results->setProperty("dopplerInterpolation", dopplerResults);
+
+    auto approximationPassed = false;
+    results->setProperty("cutoffApproximation", checkCutoffApproximation(approximationPassed));
+
+    const auto json = juce::JSON::toString(juce::var(results));
+
+    if (! approximationPassed)
+        std::cerr << "cutoffApprox or cutoffLookup exceeds its bound in AirAbsorption, or a cutoff is not finite" << std::endl;
+
+    if (options.output != juce::File())
+        return options.output.replaceWithText(json) && approximationPassed ? 0 : 1;
+
+    std::cout << json << std::endl;
+    return approximationPassed ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    AbsorptionFilter.cpp
+    Created: 17 Oct 2026 10:02:11am
+    Author:  regnier
+    Brief: 1-pole TPT lowpass with control-rate coefficient updates.
+
+  ==============================================================================
+*/
+
+#include "AbsorptionFilter.h"
+
+void AbsorptionFilter::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+    state.resize(spec.numChannels);
+    reset();
+}
+
+void AbsorptionFilter::reset()
+{
+    std::fill(state.begin(), state.end(), 0.0f);
+}
+
+float AbsorptionFilter::coefficientFor(float cutoff_hz, double sampleRate)
+{
+    // keep below nyquist, tan() blows up at fs/2
+    const auto fc = juce::jlimit(0.0, 0.499 * sampleRate, (double)cutoff_hz);
+    const auto g = std::tan(juce::MathConstants<double>::pi * fc / sampleRate);
+    return (float)(g / (1.0 + g));
+}
+
+void AbsorptionFilter::setCutoffFrequency(float cutoff_hz)
+{
+    coefficient = targetCoefficient = coefficientFor(cutoff_hz, sampleRate);
+    coefficientStep = 0.0f;
+    rampRemaining = 0;
+}
+
+void AbsorptionFilter::rampCutoffFrequency(float cutoff_hz, int numSamples)
+{
+    targetCoefficient = coefficientFor(cutoff_hz, sampleRate);
+
+    if (numSamples <= 1)
+    {
+        coefficient = targetCoefficient;
+        rampRemaining = 0;
+        return;
+    }
+
+    coefficientStep = (targetCoefficient - coefficient) / (float)numSamples;
+    rampRemaining = numSamples;
+}
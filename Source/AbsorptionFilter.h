@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    AbsorptionFilter.h
+    Created: 17 Oct 2026 10:02:11am
+    @Author:  regnier
+    @Brief: 1-pole TPT lowpass used for the air absorption. Same topology as juce::dsp::FirstOrderTPTFilter,
+    but the coefficient can be updated at control rate and linearly interpolated in between,
+    so tan() is only evaluated once every N samples (and not at all when the cutoff is not moving).
+    Channels can also be run in juce::dsp::SIMDRegister lanes, laneWidth channels for the cost of one:
+    the state is moved to lane registers for a segment (loadLanes), stepped with processLanes, then stored back.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+class AbsorptionFilter
+{
+    public:
+
+        using Register = juce::dsp::SIMDRegister<float>;
+        static constexpr int laneWidth = (int)Register::SIMDNumElements;
+
+        void prepare(const juce::dsp::ProcessSpec& spec);
+        void reset();
+
+        /* set the cutoff immediately, cancels any running ramp */
+        void setCutoffFrequency(float cutoff_hz);
+
+        /* ramp the coefficient linearly toward the given cutoff over the next numSamples coefficients */
+        void rampCutoffFrequency(float cutoff_hz, int numSamples);
+
+        /* compute the TPT coefficient G / (1 + G), with G = tan(pi * fc / fs) */
+        static float coefficientFor(float cutoff_hz, double sampleRate);
+
+        /* write the next numSamples coefficients of the current ramp (constant when not ramping) */
+        void fillCoefficients(float* coefficients, int numSamples) noexcept
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                if (rampRemaining > 0)
+                {
+                    coefficient += coefficientStep;
+                    if (--rampRemaining == 0)
+                        coefficient = targetCoefficient; // avoid accumulated rounding
+                }
+
+                coefficients[i] = coefficient;
+            }
+        }
+
+        inline float processSample(int channel, float inputValue, float g) noexcept
+        {
+            auto& s = state[(size_t)channel];
+            const auto v = g * (inputValue - s);
+            const auto y = v + s;
+            s = y + v;
+            return y;
+        }
+
+        /* one TPT step on laneWidth channels at once, one per lane, with a coefficient per lane */
+        static inline Register processLanes(Register x, Register g, Register& s) noexcept
+        {
+            const auto v = g * (x - s);
+            const auto y = v + s;
+            s = y + v;
+            return y;
+        }
+
+        /* states of channels [firstChannel, firstChannel + numChannels) to / from (numChannels + laneWidth - 1) / laneWidth
+           lane registers. padding lanes are loaded as 0 and never stored, so a group may straddle the next bank */
+        void loadLanes(int firstChannel, int numChannels, Register* lanes) const noexcept
+        {
+            for (int group = 0; group * laneWidth < numChannels; ++group)
+            {
+                alignas(32) float frame[laneWidth];
+
+                for (int lane = 0; lane < laneWidth; ++lane)
+                {
+                    const auto channel = group * laneWidth + lane;
+                    frame[lane] = channel < numChannels ? state[(size_t)(firstChannel + channel)] : 0.0f;
+                }
+
+                lanes[group] = Register::fromRawArray(frame);
+            }
+        }
+
+        void storeLanes(int firstChannel, int numChannels, const Register* lanes) noexcept
+        {
+            for (int group = 0; group * laneWidth < numChannels; ++group)
+            {
+                alignas(32) float frame[laneWidth];
+                lanes[group].copyToRawArray(frame);
+
+                for (int lane = 0; lane < laneWidth && group * laneWidth + lane < numChannels; ++lane)
+                    state[(size_t)(firstChannel + group * laneWidth + lane)] = frame[lane];
+            }
+        }
+
+        /* state handling, used when switching processing kernels */
+        void copyState(int sourceChannel, int destChannel) noexcept { state[(size_t)destChannel] = state[(size_t)sourceChannel]; }
+        void resetChannel(int channel) noexcept { state[(size_t)channel] = 0.0f; }
+
+        bool isRamping() const noexcept { return rampRemaining > 0; }
+
+    private:
+
+        double sampleRate = 44100.0;
+        std::vector<float> state;
+
+        float coefficient = 0.0f;
+        float targetCoefficient = 0.0f;
+        float coefficientStep = 0.0f;
+        int rampRemaining = 0;
+};
@@ -12,6 +12,57 @@
 
 #include "AirAbsorption.h"
 
+// float log2 / exp2 for cutoffApprox, ~1e-7 relative, no libm call
+static inline float fastLog2(const float x) noexcept
+{
+    juce::uint32 bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+
+    // x = m * 2^exponent, m in [sqrt(0.5), sqrt(2))
+    int exponent = (int)((bits >> 23) & 0xff) - 127;
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    if (m > 1.41421356f)
+    {
+        m *= 0.5f;
+        ++exponent;
+    }
+
+    // log2(m) = 2 / ln(2) * atanh(t), t = (m - 1) / (m + 1), |t| < 0.172
+    const float t = (m - 1.0f) / (m + 1.0f);
+    const float t2 = t * t;
+    return (float)exponent + t * (2.88539008f + t2 * (0.961796694f + t2 * (0.577078016f + t2 * 0.412198583f)));
+}
+
+static inline float fastExp2(const float x) noexcept
+{
+    // truncation of a positive value is floor
+    const float clamped = juce::jlimit(-126.0f, 126.0f, x);
+    const int whole = (int)(clamped + 127.0f) - 127;
+    const float f = clamped - (float)whole;
+
+    // 2^f on [0, 1), degree 5 Chebyshev fit
+    const float p = 0.99999990f + f * (0.693154490f + f * (0.240141818f + f * (0.0558603371f + f * (0.00894959042f + f * 0.00189375406f))));
+
+    const juce::uint32 bits = (juce::uint32)(whole + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+// log-distance mapping of the cutoff table
+static const double kCutoffTableLogMin = std::log(AirAbsorption::kCutoffTableMinDistance);
+static const double kCutoffTableLogStep = (std::log(AirAbsorption::kCutoffTableMaxDistance) - kCutoffTableLogMin) / (AirAbsorption::kCutoffTableSize - 1);
+
+AirAbsorption::AirAbsorption()
+{
+    FilterCutoffSolver(50.0, 20.0, kPressureSeaLevelPascals);
+    fitCutoffApprox(kDefaultCutoffGain, 0);
+    cutoffFits[1] = cutoffFits[0];
+}
+
 double AirAbsorption::CelsiusToKelvin(const double celsius)
 {
     return (celsius + 273.15);
@@ -133,7 +184,8 @@ double AirAbsorption::FindFirstRoot(double a, double b, double c, double d) {
     double p = (3 * a * c - b * b) / (3 * a * a);
     double q = ((2.0 * b * b * b) - (9 * b * a * c) + (27 * a * d * a)) / (27 * a * a * a);
 
-    const double theta = (3 * q * sqrt(-3 / p)) / (2 * p);
+    // clamped: rounding can push it just outside [-1, 1] for dry air at short distances, and acos would return NaN
+    const double theta = juce::jlimit(-1.0, 1.0, (3 * q * sqrt(-3 / p)) / (2 * p));
     double t0 = 2 * sqrt(-p / 3) * cos(acos(theta) / 3);
 
     // descriminate = -(4p^3 + 27q^2)
@@ -166,3 +218,195 @@ double AirAbsorption::cutoffSolve(const double distance, const double cutoff_gai
     const double frequency_hz = sqrt(root);
     return frequency_hz;
 }
+
+
+void AirAbsorption::cutoffSolve(const double* distances, double* cutoffs, const int num_distances, const double cutoff_gain) const
+{
+    const double nitrogen_sq = nitrogen_relax_freq * nitrogen_relax_freq;
+    const double oxygen_sq = oxygen_relax_freq * oxygen_relax_freq;
+
+    // distance independent parts of the cubic coefficients, a4 is added in the loop
+    const double a = a1;
+    const double b0 = a1 * (nitrogen_sq + oxygen_sq) + a2 * nitrogen_relax_freq + a3 * oxygen_relax_freq;
+    const double c0 = a1 * nitrogen_sq * oxygen_sq + a2 * oxygen_sq * nitrogen_relax_freq + a3 * nitrogen_sq * oxygen_relax_freq;
+    const double sum_sq = nitrogen_sq + oxygen_sq;
+    const double prod_sq = nitrogen_sq * oxygen_sq;
+
+    const double inv_3a = 1.0 / (3 * a);
+    const double inv_3a2 = 1.0 / (3 * a * a);
+    const double inv_27a3 = 1.0 / (27 * a * a * a);
+
+    for (int i = 0; i < num_distances; ++i)
+    {
+        const double a4 = -cutoff_gain / distances[i];
+        const double b = b0 + a4;
+        const double c = c0 + a4 * sum_sq;
+        const double d = a4 * prod_sq;
+
+        // depressed cubic, as in FindFirstRoot
+        const double p = (3 * a * c - b * b) * inv_3a2;
+        const double q = ((2.0 * b * b * b) - (9 * b * a * c) + (27 * a * d * a)) * inv_27a3;
+        const double m = std::sqrt(-p / 3);
+        const double theta = juce::jlimit(-1.0, 1.0, (3 * q) / (2 * p * m));
+
+        // cos(acos(theta) / 3) == cos(2/3 * acos(s)) with s = sqrt((1 + theta) / 2), which is smooth in s on [0, 1].
+        // degree 7 Chebyshev fit, max error 2.6e-8
+        const double s = std::sqrt(0.5 * (1.0 + theta));
+        const double t = 0.5000000260258304 + s * (0.577346917369617 + s * (-0.1110385112471512 + s * (0.052841409141857865
+            + s * (-0.030235397568298517 + s * (0.01604728036823211 + s * (-0.006089345676855373 + s * 0.0011276362381238414))))));
+
+        // one Newton step on the original cubic brings the root back to full precision
+        double root = 2 * m * t - b * inv_3a;
+        root -= (((a * root + b) * root + c) * root + d) / ((3 * a * root + 2 * b) * root + c);
+
+        cutoffs[i] = std::sqrt(root);
+    }
+}
+
+void AirAbsorption::buildCutoffTable(const double cutoff_gain)
+{
+    const int inactive = 1 - activeTable.load();
+
+    // a reader that picked this slot before the last flip may still be on it: wait until it is done
+    while (tableReaders[(size_t)inactive].load() != 0)
+        std::this_thread::yield();
+
+    // batch solver, theta is clamped there: never a NaN in what the filters get
+    std::array<double, kCutoffTableSize> cutoffs;
+    for (int i = 0; i < kCutoffTableSize; ++i)
+        cutoffs[(size_t)i] = std::exp(kCutoffTableLogMin + i * kCutoffTableLogStep);
+
+    cutoffSolve(cutoffs.data(), cutoffs.data(), kCutoffTableSize, cutoff_gain);
+
+    auto& table = cutoffTables[(size_t)inactive];
+    for (int i = 0; i < kCutoffTableSize; ++i)
+        table[(size_t)i] = (float)cutoffs[(size_t)i];
+
+    fitCutoffApprox(cutoff_gain, inactive);
+
+    activeTable.store(inactive);
+}
+
+int AirAbsorption::acquireTable() const noexcept
+{
+    // the slot is pinned only if it is still the active one once counted, so the builder never writes a pinned slot
+    for (;;)
+    {
+        const auto slot = activeTable.load();
+        tableReaders[(size_t)slot].fetch_add(1);
+
+        if (activeTable.load() == slot)
+            return slot;
+
+        tableReaders[(size_t)slot].fetch_sub(1);
+    }
+}
+
+void AirAbsorption::releaseTable(const int slot) const noexcept
+{
+    tableReaders[(size_t)slot].fetch_sub(1);
+}
+
+float AirAbsorption::cutoffLookup(const double distance) const
+{
+    const auto slot = acquireTable();
+    const auto& table = cutoffTables[(size_t)slot];
+
+    const double position = juce::jlimit(0.0, (double)(kCutoffTableSize - 1),
+        (std::log(juce::jmax(distance, kCutoffTableMinDistance)) - kCutoffTableLogMin) / kCutoffTableLogStep);
+    const int index = juce::jmin((int)position, kCutoffTableSize - 2);
+    const float frac = (float)(position - index);
+
+    const auto cutoff = table[(size_t)index] + frac * (table[(size_t)index + 1] - table[(size_t)index]);
+    releaseTable(slot);
+    return cutoff;
+}
+
+double AirAbsorption::distanceForCutoff(const double frequency_hz, const double cutoff_gain) const
+{
+    // the equation cutoffSolve inverts: absorption(f) = cutoff_gain / distance
+    const double f_sq = frequency_hz * frequency_hz;
+    const double absorption = a1 * f_sq
+        + a2 * nitrogen_relax_freq * f_sq / (nitrogen_relax_freq * nitrogen_relax_freq + f_sq)
+        + a3 * oxygen_relax_freq * f_sq / (oxygen_relax_freq * oxygen_relax_freq + f_sq);
+
+    return cutoff_gain / absorption;
+}
+
+void AirAbsorption::fitCutoffApprox(const double cutoff_gain, const int slot)
+{
+    auto& fit = cutoffFits[(size_t)slot];
+
+    // batch solver: theta is clamped there, the scalar one can return NaN for extreme atmospheres
+    auto solve = [this, cutoff_gain](double distance)
+    {
+        double cutoff;
+        cutoffSolve(&distance, &cutoff, 1, cutoff_gain);
+        return cutoff;
+    };
+
+    // cutoff range covered by the DIST range, capped
+    const double log_f_min = std::log2(solve(kCutoffTableMaxDistance));
+    const double log_f_max = std::log2(juce::jmin((double)kFastCutoffMaxFrequency, solve(kCutoffTableMinDistance)));
+
+    // boundaries evenly spaced in log cutoff, mapped back to distance. the cutoff decreases with distance, hence the reversed index
+    for (int k = 0; k <= kFastCutoffSegments; ++k)
+    {
+        const double log_f = log_f_max + (log_f_min - log_f_max) * k / kFastCutoffSegments;
+        fit.boundaries[(size_t)k] = (float)std::log2(distanceForCutoff(std::exp2(log_f), cutoff_gain));
+    }
+
+    fit.boundaries[0] = juce::jmax(fit.boundaries[0], (float)std::log2(kCutoffTableMinDistance));
+    fit.boundaries[kFastCutoffSegments] = (float)std::log2(kCutoffTableMaxDistance);
+
+    for (int s = 0; s < kFastCutoffSegments; ++s)
+    {
+        const double lower = fit.boundaries[(size_t)s];
+        const double upper = fit.boundaries[(size_t)s + 1];
+        const double centre = 0.5 * (lower + upper);
+        const double half_width = juce::jmax(0.5 * (upper - lower), 1.0e-6);
+
+        // cubic interpolation at the 4 Chebyshev nodes (close to minimax), in x = (u - centre) / half_width
+        double cheb[4] = {};
+
+        for (int k = 0; k < 4; ++k)
+        {
+            const double angle = juce::MathConstants<double>::pi * (k + 0.5) / 4;
+            const double y = std::log2(solve(std::exp2(centre + half_width * std::cos(angle))));
+
+            for (int j = 0; j < 4; ++j)
+                cheb[j] += 0.5 * y * std::cos(j * angle);
+        }
+
+        cheb[0] *= 0.5;
+
+        // T0 = 1, T1 = x, T2 = 2x^2 - 1, T3 = 4x^3 - 3x
+        auto& c = fit.coefficients[(size_t)s];
+        c[0] = (float)(cheb[0] - cheb[2]);
+        c[1] = (float)(cheb[1] - 3.0 * cheb[3]);
+        c[2] = (float)(2.0 * cheb[2]);
+        c[3] = (float)(4.0 * cheb[3]);
+
+        fit.centres[(size_t)s] = (float)centre;
+        fit.inverseHalfWidths[(size_t)s] = (float)(1.0 / half_width);
+    }
+}
+
+float AirAbsorption::cutoffApprox(const float distance) const noexcept
+{
+    const auto slot = acquireTable();
+    const auto& fit = cutoffFits[(size_t)slot];
+    const float u = fastLog2(juce::jmax(distance, (float)kCutoffTableMinDistance));
+
+    // branch-free binary search of the segment
+    int s = 0;
+    for (int step = kFastCutoffSegments / 2; step > 0; step /= 2)
+        s += u >= fit.boundaries[(size_t)(s + step)] ? step : 0;
+
+    const auto& c = fit.coefficients[(size_t)s];
+    const float x = juce::jlimit(-1.0f, 1.0f, (u - fit.centres[(size_t)s]) * fit.inverseHalfWidths[(size_t)s]);
+
+    const auto cutoff = fastExp2(c[0] + x * (c[1] + x * (c[2] + x * c[3])));
+    releaseTable(slot);
+    return cutoff;
+}
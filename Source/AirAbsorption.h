@@ -12,11 +12,20 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "AirAbsorptionTable.h"
+
+/* cutoff used by the processors: 0 table lookup, 1 fast float approximation (cutoffApprox) */
+#ifndef IOSONO_FAST_CUTOFF
+ #define IOSONO_FAST_CUTOFF 0
+#endif
 
 class AirAbsorption
 {
     public:
 
+        /* standard atmosphere (50 %, 20 C, sea level), same as the built-in table */
+        AirAbsorption();
+
         void FilterCutoffSolver(
             const double humidity_percent,
             const double temperature_farenheit,
@@ -24,6 +33,57 @@ class AirAbsorption
 
         double cutoffSolve(const double distance, const double cutoff_gain);
 
+        /* Batch version of cutoffSolve, for arrays of distances (many sources, or every sample of a distance ramp).
+           Same cubic, but the acos/cos step of FindFirstRoot is replaced by a polynomial followed by one Newton step,
+           so the loop is branch-free arithmetic + sqrt, vectorised by the compiler with the flags CMakeLists.txt sets for
+           AirAbsorption.cpp (-fno-math-errno -fno-trapping-math). buildCutoffTable() uses it. distances and cutoffs may alias. */
+        void cutoffSolve(const double* distances, double* cutoffs, const int num_distances, const double cutoff_gain) const;
+
+        /* Cutoff vs distance table, log-spaced over the DIST range, linearly interpolated.
+           Built for the atmosphere last passed to FilterCutoffSolver(). Lookups are cheap enough to be done per block. */
+        static constexpr int kCutoffTableSize = 512;
+        static constexpr double kCutoffTableMinDistance = 0.1;
+        static constexpr double kCutoffTableMaxDistance = 300.0;
+        static constexpr double kDefaultCutoffGain = 3.0;
+        /* relative error of cutoffLookup vs cutoffSolve over the same ranges as cutoffApprox (checked by IOSONOBenchmarks, measured 9.4e-3) */
+        static constexpr double kCutoffTableMaxError = 1.0e-2;
+
+        /* solve the whole table for the current atmosphere and publish it. Not real-time safe, call from a background thread. */
+        void buildCutoffTable(const double cutoff_gain);
+
+        /* interpolated table read, lock-free */
+        float cutoffLookup(const double distance) const;
+
+        /* Fast float path: log2(cutoff) as a piecewise cubic of log2(distance), fitted by buildCutoffTable() at the same time as the table.
+           Segment boundaries are evenly spaced in log cutoff rather than in distance, so the steep part of the curve
+           (dry air, where the cutoff drops quickly over a few meters) gets short segments.
+           Cutoffs are capped at kFastCutoffMaxFrequency, which covers 0.499 * fs up to 192 kHz.
+           Relative error vs cutoffSolve is below kFastCutoffMaxError over the DIST range, for humidity 0-100 %,
+           -20 to 50 C and 800-1100 hPa (checked by IOSONOBenchmarks, measured 1.7e-4). */
+        static constexpr int kFastCutoffSegments = 16; // power of 2, for the segment search
+        static constexpr float kFastCutoffMaxFrequency = 96000.0f;
+        static constexpr double kFastCutoffMaxError = 5.0e-4;
+
+        /* lock-free, one log2, one exp2 and a cubic */
+        float cutoffApprox(const float distance) const noexcept;
+
+        /* what the processors call, per block */
+        float cutoffFor(const float distance) const noexcept
+        {
+           #if IOSONO_FAST_CUTOFF
+            return cutoffApprox(distance);
+           #else
+            return cutoffLookup(distance);
+           #endif
+        }
+
+        /* exact attenuation model, dB per meter at frequency_hz. Used to check the solvers against the original equation. */
+        double AbsorptionCoefficient(
+            const double frequency_hz,
+            const double humidity_percent,
+            const double temperature_celsius,
+            const double pressure_pascals);
+
         const double kPressureSeaLevelPascals = 101325.0;
         const double kReferenceAirTemperature = 293.15;
 
@@ -45,15 +105,34 @@ class AirAbsorption
             double humidity_concentration,
             double pressure_normalized);
 
-        double AbsorptionCoefficient(
-            const double frequency_hz,
-            const double humidity_percent,
-            const double temperature_celsius,
-            const double pressure_pascals);
-
         double FindFirstRoot(double a, double b, double c, double d);
 
+        /* distance at which the cutoff is frequency_hz, i.e. the inverse of cutoffSolve (explicit) */
+        double distanceForCutoff(const double frequency_hz, const double cutoff_gain) const;
+
+        void fitCutoffApprox(const double cutoff_gain, const int slot);
+
+        struct CutoffFit
+        {
+            std::array<float, kFastCutoffSegments + 1> boundaries;      // log2(distance), increasing
+            std::array<float, kFastCutoffSegments> centres;
+            std::array<float, kFastCutoffSegments> inverseHalfWidths;
+            std::array<std::array<float, 4>, kFastCutoffSegments> coefficients; // monomial, in x = (u - centre) * inverseHalfWidth
+        };
+
         double nitrogen_relax_freq;
         double oxygen_relax_freq;
         double a1, a2, a3;
+
+        /* readers pin the active slot for the duration of a read, lock-free (a counter each) */
+        int acquireTable() const noexcept;
+        void releaseTable(const int slot) const noexcept;
+
+        /* double buffered: the builder (one at a time) writes the inactive table (and fit) then flips activeTable.
+           a slot still pinned by a reader that loaded it before the last flip is not rewritten until the reader is done */
+        /* both start as the compile-time standard atmosphere table (AirAbsorptionTable.h) */
+        std::array<std::array<float, kCutoffTableSize>, 2> cutoffTables { AirAbsorptionTable::standardAtmosphere, AirAbsorptionTable::standardAtmosphere };
+        std::array<CutoffFit, 2> cutoffFits;
+        std::atomic<int> activeTable { 0 };
+        mutable std::array<std::atomic<int>, 2> tableReaders {};
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    AirAbsorptionTable.h
+    Created: 17 Oct 2026 11:20:37am
+    @Author:  regnier
+    @Brief: Default cutoff vs distance table, for standard atmosphere (50% humidity, 20 degrees, sea level pressure)
+    and a cutoff gain of 3. Generated offline from AirAbsorption::FilterCutoffSolver / cutoffSolve, so that no
+    solving is needed until the atmosphere parameters are changed.
+    Entry i is the cutoff (Hz) at distance 0.1 * (300 / 0.1)^(i / 511), i.e. log-spaced over the DIST range.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <array>
+
+namespace AirAbsorptionTable
+{
+    inline constexpr std::array<float, 512> standardAtmosphere
+    {
+        419462.871f, 415971.632f, 412505.863f, 409065.349f, 405649.878f, 402259.238f, 398893.221f, 395551.617f,
+        392234.221f, 388940.828f, 385671.233f, 382425.235f, 379202.633f, 376003.226f, 372826.818f, 369673.211f,
+        366542.21f, 363433.621f, 360347.252f, 357282.911f, 354240.408f, 351219.555f, 348220.163f, 345242.048f,
+        342285.024f, 339348.907f, 336433.516f, 333538.668f, 330664.185f, 327809.887f, 324975.597f, 322161.139f,
+        319366.337f, 316591.018f, 313835.008f, 311098.136f, 308380.232f, 305681.126f, 303000.65f, 300338.636f,
+        297694.919f, 295069.333f, 292461.714f, 289871.9f, 287299.728f, 284745.038f, 282207.67f, 279687.465f,
+        277184.266f, 274697.915f, 272228.258f, 269775.138f, 267338.403f, 264917.9f, 262513.476f, 260124.982f,
+        257752.266f, 255395.181f, 253053.578f, 250727.309f, 248416.23f, 246120.193f, 243839.057f, 241572.675f,
+        239320.908f, 237083.612f, 234860.647f, 232651.873f, 230457.152f, 228276.345f, 226109.316f, 223955.928f,
+        221816.045f, 219689.535f, 217576.262f, 215476.095f, 213388.903f, 211314.553f, 209252.917f, 207203.866f,
+        205167.272f, 203143.007f, 201130.947f, 199130.966f, 197142.94f, 195166.746f, 193202.263f, 191249.369f,
+        189307.946f, 187377.874f, 185459.035f, 183551.315f, 181654.597f, 179768.768f, 177893.715f, 176029.328f,
+        174175.497f, 172332.112f, 170499.069f, 168676.261f, 166863.584f, 165060.938f, 163268.222f, 161485.337f,
+        159712.188f, 157948.681f, 156194.723f, 154450.226f, 152715.101f, 150989.264f, 149272.633f, 147565.129f,
+        145866.676f, 144177.202f, 142496.635f, 140824.911f, 139161.967f, 137507.744f, 135862.19f, 134225.253f,
+        132596.89f, 130977.061f, 129365.73f, 127762.87f, 126168.458f, 124582.476f, 123004.915f, 121435.772f,
+        119875.052f, 118322.767f, 116778.938f, 115243.594f, 113716.773f, 112198.524f, 110688.905f, 109187.985f,
+        107695.843f, 106212.57f, 104738.269f, 103273.056f, 101817.057f, 100370.415f, 98933.2818f, 97505.827f,
+        96088.2316f, 94680.6913f, 93283.4158f, 91896.6288f, 90520.5678f, 89155.4841f, 87801.642f, 86459.3186f,
+        85128.8029f, 83810.3953f, 82504.4059f, 81211.1541f, 79930.9667f, 78664.1764f, 77411.1201f, 76172.1373f,
+        74947.5676f, 73737.7487f, 72543.0142f, 71363.6909f, 70200.0969f, 69052.5385f, 67921.3082f, 66806.6821f,
+        65708.9177f, 64628.2516f, 63564.8974f, 62519.0444f, 61490.8554f, 60480.4656f, 59487.9818f, 58513.4814f,
+        57557.0119f, 56618.591f, 55698.2066f, 54795.8171f, 53911.3526f, 53044.7151f, 52195.7802f, 51364.3983f,
+        50550.3961f, 49753.5781f, 48973.7285f, 48210.613f, 47463.9806f, 46733.5651f, 46019.0875f, 45320.2575f,
+        44636.7752f, 43968.3327f, 43314.6161f, 42675.3065f, 42050.0816f, 41438.6174f, 40840.5886f, 40255.6703f,
+        39683.539f, 39123.8731f, 38576.3541f, 38040.667f, 37516.5012f, 37003.5508f, 36501.5152f, 36010.0994f,
+        35529.0144f, 35057.9773f, 34596.7119f, 34144.9482f, 33702.4232f, 33268.8804f, 32844.0704f, 32427.7504f,
+        32019.6843f, 31619.6429f, 31227.4036f, 30842.7502f, 30465.4733f, 30095.3696f, 29732.2422f, 29375.9f,
+        29026.1582f, 28682.8377f, 28345.765f, 28014.7722f, 27689.6966f, 27370.381f, 27056.6729f, 26748.425f,
+        26445.4946f, 26147.7437f, 25855.0386f, 25567.2499f, 25284.2526f, 25005.9256f, 24732.1515f, 24462.817f,
+        24197.8121f, 23937.0306f, 23680.3694f, 23427.729f, 23179.0127f, 22934.127f, 22692.9813f, 22455.488f,
+        22221.5619f, 21991.1208f, 21764.0847f, 21540.3763f, 21319.9205f, 21102.6445f, 20888.4779f, 20677.3521f,
+        20469.2008f, 20263.9595f, 20061.5657f, 19861.9587f, 19665.0797f, 19470.8714f, 19279.2783f, 19090.2465f,
+        18903.7234f, 18719.6583f, 18538.0016f, 18358.7051f, 18181.7222f, 18007.0074f, 17834.5164f, 17664.2062f,
+        17496.035f, 17329.9621f, 17165.9478f, 17003.9536f, 16843.9418f, 16685.876f, 16529.7205f, 16375.4407f,
+        16223.0027f, 16072.3736f, 15923.5213f, 15776.4145f, 15631.0227f, 15487.3162f, 15345.266f, 15204.8438f,
+        15066.0219f, 14928.7735f, 14793.0722f, 14658.8925f, 14526.2092f, 14394.9979f, 14265.2347f, 14136.8963f,
+        14009.9598f, 13884.4032f, 13760.2045f, 13637.3425f, 13515.7965f, 13395.5461f, 13276.5714f, 13158.853f,
+        13042.3719f, 12927.1096f, 12813.0477f, 12700.1686f, 12588.4548f, 12477.8892f, 12368.4552f, 12260.1364f,
+        12152.9168f, 12046.7807f, 11941.7128f, 11837.698f, 11734.7216f, 11632.7691f, 11531.8264f, 11431.8796f,
+        11332.9151f, 11234.9195f, 11137.8799f, 11041.7833f, 10946.6171f, 10852.3691f, 10759.027f, 10666.5791f,
+        10575.0137f, 10484.3193f, 10394.4846f, 10305.4987f, 10217.3507f, 10130.0299f, 10043.526f, 9957.82868f,
+        9872.92781f, 9788.81352f, 9705.47607f, 9622.9059f, 9541.09361f, 9460.02997f, 9379.70589f, 9300.11244f,
+        9221.24085f, 9143.08247f, 9065.62882f, 8988.87154f, 8912.80243f, 8837.41339f, 8762.69648f, 8688.64387f,
+        8615.24785f, 8542.50085f, 8470.39541f, 8398.92418f, 8328.07993f, 8257.85554f, 8188.24399f, 8119.23839f,
+        8050.83194f, 7983.01792f, 7915.78974f, 7849.14091f, 7783.06501f, 7717.55573f, 7652.60685f, 7588.21224f,
+        7524.36585f, 7461.06172f, 7398.29399f, 7336.05685f, 7274.3446f, 7213.15161f, 7152.47232f, 7092.30125f,
+        7032.63301f, 6973.46225f, 6914.78373f, 6856.59225f, 6798.88269f, 6741.65f, 6684.8892f, 6628.59536f,
+        6572.76362f, 6517.38919f, 6462.46733f, 6407.99338f, 6353.96271f, 6300.37076f, 6247.21305f, 6194.48511f,
+        6142.18257f, 6090.30108f, 6038.83635f, 5987.78417f, 5937.14034f, 5886.90073f, 5837.06126f, 5787.61789f,
+        5738.56664f, 5689.90356f, 5641.62476f, 5593.72638f, 5546.20462f, 5499.05571f, 5452.27593f, 5405.8616f,
+        5359.80907f, 5314.11475f, 5268.77507f, 5223.78652f, 5179.1456f, 5134.84888f, 5090.89294f, 5047.2744f,
+        5003.98994f, 4961.03624f, 4918.41003f, 4876.10809f, 4834.1272f, 4792.46419f, 4751.11594f, 4710.07932f,
+        4669.35127f, 4628.92874f, 4588.80871f, 4548.98819f, 4509.46423f, 4470.23391f, 4431.29431f, 4392.64256f,
+        4354.27581f, 4316.19125f, 4278.38608f, 4240.85753f, 4203.60285f, 4166.61933f, 4129.90427f, 4093.45499f,
+        4057.26885f, 4021.34323f, 3985.67552f, 3950.26314f, 3915.10353f, 3880.19416f, 3845.5325f, 3811.11607f,
+        3776.94239f, 3743.00899f, 3709.31346f, 3675.85336f, 3642.6263f, 3609.62991f, 3576.86181f, 3544.31968f,
+        3512.00118f, 3479.904f, 3448.02585f, 3416.36446f, 3384.91757f, 3353.68294f, 3322.65833f, 3291.84153f,
+        3261.23035f, 3230.82261f, 3200.61613f, 3170.60877f, 3140.79837f, 3111.18282f, 3081.76f, 3052.52781f,
+        3023.48416f, 2994.62698f, 2965.95419f, 2937.46376f, 2909.15363f, 2881.02178f, 2853.06619f, 2825.28485f,
+        2797.67576f, 2770.23695f, 2742.96642f, 2715.86222f, 2688.92239f, 2662.14498f, 2635.52805f, 2609.06967f,
+        2582.76792f, 2556.62089f, 2530.62668f, 2504.78338f, 2479.08912f, 2453.54201f, 2428.14018f, 2402.88177f,
+        2377.76492f, 2352.78779f, 2327.94853f, 2303.24532f, 2278.67632f, 2254.23973f, 2229.93373f, 2205.75652f,
+        2181.70631f, 2157.78131f, 2133.97975f, 2110.29987f, 2086.73989f, 2063.29809f, 2039.97271f, 2016.76203f
+    };
+}
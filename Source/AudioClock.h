@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    AudioClock.h
+    Created: 18 Oct 2026 2:37:18pm
+    @Author:  regnier
+    @Brief: Wall-clock time of the audio stream, derived from the number of samples processed
+    rather than from when the host happens to call processBlock, so it does not jitter with
+    host buffering. Re-anchored to the system clock when the two drift apart (xruns, transport jumps...).
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+class AudioClock
+{
+    public:
+
+        void reset(double newSampleRate)
+        {
+            sampleRate = newSampleRate;
+            samplesSinceAnchor = 0;
+            anchored = false;
+        }
+
+        /* call once at the start of each block. returns the time of the first sample of the block,
+           in ms since 1970 (same origin as juce::Time) */
+        double blockStart(int numSamples) noexcept
+        {
+            const auto now = (double)juce::Time::currentTimeMillis();
+            auto predicted = anchorMs + (double)samplesSinceAnchor * 1000.0 / sampleRate;
+
+            if (! anchored || std::abs(now - predicted) > resyncThresholdMs)
+            {
+                anchorMs = predicted = now;
+                samplesSinceAnchor = 0;
+                anchored = true;
+            }
+
+            samplesSinceAnchor += numSamples;
+            return predicted;
+        }
+
+    private:
+
+        static constexpr double resyncThresholdMs = 50.0;
+
+        double sampleRate = 44100.0;
+        double anchorMs = 0.0;
+        juce::int64 samplesSinceAnchor = 0;
+        bool anchored = false;
+};
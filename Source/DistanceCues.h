@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    DistanceCues.h
+    Created: 17 Oct 2026 2:41:09pm
+    @Author:  regnier
+    @Brief: Distance laws shared by the single and multi source processors:
+    level attenuation, propagation delay (optionally latency compensated) and IOSONO azimuth convention.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+namespace DistanceCues
+{
+    /* DIST parameter range, the lower bound avoids a 0-sample delay and infinite gain */
+    static constexpr float kMinDistance = 0.1f;
+    static constexpr float kMaxDistance = 300.0f;
+
+    /* 1 / speed of sound, 340 m/s */
+    static constexpr float kSecondsPerMeter = 2.94117647f * 0.001f;
+
+    /* (radius / distance)^factor, unity inside the radius */
+    inline float gainForDistance(float distance, float radius, float factor)
+    {
+        const auto clampedDistance = juce::jlimit(radius, kMaxDistance, distance);
+        return juce::jlimit(0.0f, 1.0f, std::pow(radius / clampedDistance, factor));
+    }
+
+    /* propagation delay in samples, at least one sample, minus the part reported to the host as latency (see below) */
+    inline float delayForDistance(float distance, double sampleRate, float maxDelaySamples, float compensationSamples = 0.0f)
+    {
+        return juce::jlimit(1.0f, maxDelaySamples, distance * kSecondsPerMeter * (float)sampleRate - compensationSamples);
+    }
+
+    /* latency compensated doppler: the propagation delay of the reference distance is taken out of the delay line and
+       reported with setLatencySamples, the host shifts the track back by as much. what is left is the doppler shift and the
+       differences of time of flight. one sample short of the reference delay, so that a source at the reference distance
+       still gets the 1-sample minimum of the line and ends up exactly on time. sources closer than the reference are late */
+    inline int latencyForReference(float referenceDistance, double sampleRate)
+    {
+        return juce::jmax(0, (int)std::floor(referenceDistance * kSecondsPerMeter * sampleRate) - 1);
+    }
+
+    /* convert from "usual" conventions - 0 deg in front, clockwise- to IOSONO - 0 deg to the right, anticlockwise - */
+    inline float toIosonoAzimuth(float azimuth)
+    {
+        azimuth = 90.0f - azimuth;
+        if (azimuth < 0) azimuth += 360.0f; // wrap around
+        return azimuth;
+    }
+}
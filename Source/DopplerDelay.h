@@ -0,0 +1,383 @@
+/*
+  ==============================================================================
+
+    DopplerDelay.h
+    Created: 19 Oct 2026 10:05:44am
+    @Author:  regnier
+    @Brief: Block based fractional delay for the doppler effect.
+    The delay is given as a per-sample ramp for the whole block. Interpolation coefficients are computed
+    once per sample and applied to all channels at once: each tap of a frame is loaded in
+    juce::dsp::SIMDRegister lanes (one lane per channel), so it is a single SIMD multiply-add.
+    Lines with fewer channels than lanes (mono, every line of the multi-source processor) use plain floats instead.
+    Frames are stored densely (no SIMD padding), optionally in 16 bit.
+    The interpolator is a template parameter: Linear, Lagrange3rd, Thiran (1st order allpass) or WindowedSinc.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/* doppler interpolation of the processors, chosen at compile time: 0 linear, 1 lagrange 3rd, 2 thiran allpass, 3 windowed sinc */
+#ifndef IOSONO_DOPPLER_INTERPOLATION
+ #define IOSONO_DOPPLER_INTERPOLATION 1
+#endif
+
+namespace DopplerInterpolation
+{
+    /* Each interpolator reads numTaps samples, at delays (delayInt + firstTap + k), k = 0..numTaps-1,
+       where delayInt + frac is the requested delay. */
+
+    struct Linear
+    {
+        static constexpr int numTaps = 2;
+        static constexpr int firstTap = 0;
+        static constexpr float minimumDelay = 0.0f;
+        static constexpr bool isAllpass = false;
+
+        static void coefficients(float t, float* c) noexcept
+        {
+            c[0] = 1.0f - t;
+            c[1] = t;
+        }
+    };
+
+    /* 4 points, centred around the fractional position (nodes -1, 0, 1, 2) */
+    struct Lagrange3rd
+    {
+        static constexpr int numTaps = 4;
+        static constexpr int firstTap = -1;
+        static constexpr float minimumDelay = 1.0f;
+        static constexpr bool isAllpass = false;
+
+        static void coefficients(float t, float* c) noexcept
+        {
+            const auto tp1 = t + 1.0f;
+            const auto tm1 = t - 1.0f;
+            const auto tm2 = t - 2.0f;
+
+            c[0] = -t * tm1 * tm2 * (1.0f / 6.0f);
+            c[1] = tp1 * tm1 * tm2 * 0.5f;
+            c[2] = -tp1 * t * tm2 * 0.5f;
+            c[3] = tp1 * t * tm1 * (1.0f / 6.0f);
+        }
+    };
+
+    /* 1st order Thiran allpass, same as juce::dsp::DelayLineInterpolationTypes::Thiran.
+       flat magnitude, but recursive: fast delay changes leave a short transient */
+    struct Thiran
+    {
+        static constexpr int numTaps = 2;
+        static constexpr int firstTap = 0;
+        static constexpr float minimumDelay = 0.618f;
+        static constexpr bool isAllpass = true;
+
+        static float coefficient(float t) noexcept { return (1.0f - t) / (1.0f + t); }
+    };
+
+    /* 8 taps, Blackman windowed sinc, coefficients read from a table of phases */
+    struct WindowedSinc
+    {
+        static constexpr int numTaps = 8;
+        static constexpr int firstTap = -3;
+        static constexpr float minimumDelay = 3.0f;
+        static constexpr bool isAllpass = false;
+
+        static constexpr int numPhases = 256;
+
+        static const std::array<float, (numPhases + 1) * numTaps>& getTable()
+        {
+            static const auto table = []
+            {
+                std::array<float, (numPhases + 1) * numTaps> t {};
+
+                for (int phase = 0; phase <= numPhases; ++phase)
+                {
+                    const auto frac = (double)phase / numPhases;
+                    double sum = 0.0;
+
+                    for (int k = 0; k < numTaps; ++k)
+                    {
+                        const auto x = (double)(k + firstTap) - frac;
+                        const auto sinc = x == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+                        const auto w = juce::MathConstants<double>::twoPi * (x / numTaps + 0.5);
+                        const auto window = 0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+                        t[(size_t)(phase * numTaps + k)] = (float)(sinc * window);
+                        sum += sinc * window;
+                    }
+
+                    // unity gain at DC
+                    for (int k = 0; k < numTaps; ++k)
+                        t[(size_t)(phase * numTaps + k)] = (float)(t[(size_t)(phase * numTaps + k)] / sum);
+                }
+
+                return t;
+            }();
+
+            return table;
+        }
+
+        static void coefficients(float t, float* c) noexcept
+        {
+            const auto& table = getTable();
+            const auto position = t * (float)numPhases;
+            const auto phase = juce::jmin((int)position, numPhases - 1);
+            const auto f = position - (float)phase;
+            const auto* c0 = table.data() + phase * numTaps;
+            const auto* c1 = c0 + numTaps;
+
+            for (int k = 0; k < numTaps; ++k)
+                c[k] = c0[k] + f * (c1[k] - c0[k]);
+        }
+    };
+
+   #if IOSONO_DOPPLER_INTERPOLATION == 0
+    using Selected = Linear;
+   #elif IOSONO_DOPPLER_INTERPOLATION == 2
+    using Selected = Thiran;
+   #elif IOSONO_DOPPLER_INTERPOLATION == 3
+    using Selected = WindowedSinc;
+   #else
+    using Selected = Lagrange3rd;
+   #endif
+}
+
+
+template <typename Interpolator>
+class DopplerDelay
+{
+    public:
+
+        using Register = juce::dsp::SIMDRegister<float>;
+        static constexpr int laneWidth = (int)Register::SIMDNumElements;
+
+        /* compact storage: 16 bit, with 12 dB of headroom above full scale (about 84 dB of dynamic range).
+           halves the memory of long lines, where the air absorption hides the extra noise anyway */
+        static constexpr float compactScale = 8192.0f;
+
+        void prepare(const juce::dsp::ProcessSpec& spec, int maximumDelaySamples, bool useCompactStorage = false)
+        {
+            numChannels = juce::jmax(1, (int)spec.numChannels);
+            numGroups = (numChannels + laneWidth - 1) / laneWidth;
+            maximumDelay = (float)maximumDelaySamples;
+            compact = useCompactStorage;
+
+            // frames are stored densely, numChannels samples per position, no padding to the SIMD width
+            const auto size = juce::nextPowerOfTwo(maximumDelaySamples + Interpolator::numTaps + Interpolator::firstTap + 2);
+            mask = size - 1;
+
+            floatBuffer.clear();
+            compactBuffer.clear();
+            floatBuffer.shrink_to_fit();
+            compactBuffer.shrink_to_fit();
+
+            if (compact)
+                compactBuffer.assign((size_t)(size * numChannels), 0);
+            else
+                floatBuffer.assign((size_t)(size * numChannels), 0.0f);
+
+            allpassState.assign((size_t)numGroups, Register::expand(0.0f));
+            scalarAllpassState.assign((size_t)numChannels, 0.0f);
+            useLanes = numChannels >= laneWidth;
+
+            if constexpr (std::is_same<Interpolator, DopplerInterpolation::WindowedSinc>::value)
+                Interpolator::getTable(); // build the table here, not on the audio thread
+
+            reset();
+        }
+
+        void reset()
+        {
+            std::fill(floatBuffer.begin(), floatBuffer.end(), 0.0f);
+            std::fill(compactBuffer.begin(), compactBuffer.end(), (juce::int16)0);
+            std::fill(allpassState.begin(), allpassState.end(), Register::expand(0.0f));
+            std::fill(scalarAllpassState.begin(), scalarAllpassState.end(), 0.0f);
+            writeIndex = 0;
+        }
+
+        /* prepare() uses the SIMD lanes from laneWidth channels on, a lane per channel would mostly be padding below.
+           the benchmarks force either path to compare them, call reset() after a change */
+        void setUseLanes(bool shouldUseLanes) noexcept { useLanes = shouldUseLanes; }
+
+        float getMaximumDelay() const noexcept { return maximumDelay; }
+
+        /* bytes used by the delay memory */
+        size_t getMemorySize() const noexcept { return floatBuffer.size() * sizeof(float) + compactBuffer.size() * sizeof(juce::int16); }
+
+        /* only write the input, to keep the line up to date while the doppler is bypassed */
+        void push(const float* const* input, int numSamples) noexcept
+        {
+            if (compact)
+                pushImpl(compactBuffer.data(), input, numSamples);
+            else
+                pushImpl(floatBuffer.data(), input, numSamples);
+        }
+
+        /* delays[n] is the delay in samples applied to sample n, for all channels. input and output may be the same */
+        void process(const float* const* input, float* const* output, int numSamples, const float* delays) noexcept
+        {
+            if (compact)
+                processImpl(compactBuffer.data(), input, output, numSamples, delays);
+            else
+                processImpl(floatBuffer.data(), input, output, numSamples, delays);
+        }
+
+    private:
+
+        static inline float toFloat(float x) noexcept          { return x; }
+        static inline float toFloat(juce::int16 x) noexcept    { return (float)x * (1.0f / compactScale); }
+        static inline void store(float& dest, float x) noexcept       { dest = x; }
+        static inline void store(juce::int16& dest, float x) noexcept { dest = (juce::int16)juce::jlimit(-32768.0f, 32767.0f, std::round(x * compactScale)); }
+
+        template <typename Sample>
+        void pushImpl(Sample* buffer, const float* const* input, int numSamples) noexcept
+        {
+            for (int n = 0; n < numSamples; ++n)
+            {
+                writeFrame(buffer, input, n);
+                writeIndex = (writeIndex + 1) & mask;
+            }
+        }
+
+        template <typename Sample>
+        void processImpl(Sample* buffer, const float* const* input, float* const* output, int numSamples, const float* delays) noexcept
+        {
+            alignas(32) float frame[laneWidth];
+            float c[Interpolator::numTaps];
+
+            for (int n = 0; n < numSamples; ++n)
+            {
+                writeFrame(buffer, input, n);
+
+                // coefficients, once for all channels
+                const auto delay = juce::jlimit(Interpolator::minimumDelay, maximumDelay, delays[n]);
+                auto delayInt = (int)delay;
+                auto t = delay - (float)delayInt;
+
+                if constexpr (Interpolator::isAllpass)
+                {
+                    // keep the fractional part in [0.618, 1.618) for a stable, well behaved allpass
+                    if (t < 0.618f && delayInt >= 1)
+                    {
+                        t += 1.0f;
+                        --delayInt;
+                    }
+
+                    const auto alpha = Interpolator::coefficient(t);
+                    const auto* frame1 = buffer + ((writeIndex - delayInt) & mask) * numChannels;
+                    const auto* frame2 = buffer + ((writeIndex - delayInt - 1) & mask) * numChannels;
+
+                    if (useLanes)
+                    {
+                        for (int g = 0; g < numGroups; ++g)
+                        {
+                            const auto value1 = loadGroup(frame1, g, frame);
+                            const auto value2 = loadGroup(frame2, g, frame);
+                            auto& state = allpassState[(size_t)g];
+
+                            state = value2 + (value1 - state) * alpha;
+                            readFrame(state, output, g, n, frame);
+                        }
+                    }
+                    else
+                    {
+                        for (int channel = 0; channel < numChannels; ++channel)
+                        {
+                            auto& state = scalarAllpassState[(size_t)channel];
+
+                            state = toFloat(frame2[channel]) + (toFloat(frame1[channel]) - state) * alpha;
+                            output[channel][n] = state;
+                        }
+                    }
+                }
+                else
+                {
+                    Interpolator::coefficients(t, c);
+
+                    const Sample* taps[Interpolator::numTaps];
+                    for (int k = 0; k < Interpolator::numTaps; ++k)
+                        taps[k] = buffer + ((writeIndex - delayInt - Interpolator::firstTap - k) & mask) * numChannels;
+
+                    if (useLanes)
+                    {
+                        for (int g = 0; g < numGroups; ++g)
+                        {
+                            auto acc = loadGroup(taps[0], g, frame) * c[0];
+
+                            for (int k = 1; k < Interpolator::numTaps; ++k)
+                                acc += loadGroup(taps[k], g, frame) * c[k];
+
+                            readFrame(acc, output, g, n, frame);
+                        }
+                    }
+                    else
+                    {
+                        for (int channel = 0; channel < numChannels; ++channel)
+                        {
+                            auto acc = toFloat(taps[0][channel]) * c[0];
+
+                            for (int k = 1; k < Interpolator::numTaps; ++k)
+                                acc += toFloat(taps[k][channel]) * c[k];
+
+                            output[channel][n] = acc;
+                        }
+                    }
+                }
+
+                writeIndex = (writeIndex + 1) & mask;
+            }
+        }
+
+        /* store sample n of every channel at writeIndex */
+        template <typename Sample>
+        inline void writeFrame(Sample* buffer, const float* const* input, int n) noexcept
+        {
+            auto* dest = buffer + writeIndex * numChannels;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                store(dest[channel], input[channel][n]);
+        }
+
+        /* channels [group * laneWidth, group * laneWidth + laneWidth) of a stored frame, one lane per channel */
+        template <typename Sample>
+        inline Register loadGroup(const Sample* stored, int group, float* frame) const noexcept
+        {
+            const auto first = group * laneWidth;
+
+            // a full group without a test per lane, so that the copy is a vector load
+            if (first + laneWidth <= numChannels)
+            {
+                for (int lane = 0; lane < laneWidth; ++lane)
+                    frame[lane] = toFloat(stored[first + lane]);
+            }
+            else
+            {
+                for (int lane = 0; lane < laneWidth; ++lane)
+                    frame[lane] = first + lane < numChannels ? toFloat(stored[first + lane]) : 0.0f;
+            }
+
+            return Register::fromRawArray(frame);
+        }
+
+        inline void readFrame(const Register& value, float* const* output, int group, int n, float* frame) const noexcept
+        {
+            value.copyToRawArray(frame);
+
+            const auto numLanes = juce::jmin(laneWidth, numChannels - group * laneWidth);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                output[group * laneWidth + lane][n] = frame[lane];
+        }
+
+        std::vector<float> floatBuffer;            // [position * numChannels + channel]
+        std::vector<juce::int16> compactBuffer;    // same layout, 16 bit storage
+        std::vector<Register> allpassState;        // thiran, one per group
+        std::vector<float> scalarAllpassState;     // thiran without lanes, one per channel
+        bool compact = false;
+        bool useLanes = false;
+        int numChannels = 1;
+        int numGroups = 1;
+        int mask = 0;
+        int writeIndex = 0;
+        float maximumDelay = 0.0f;
+};
@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    LoadMeter.h
+    Created: 21 Oct 2026 10:12:37am
+    @Author:  regnier
+    @Brief: Per instance DSP load, as a fraction of each block's real-time budget (1.0 = the whole budget).
+    The audio thread reads the CPU cycle counter at the block boundaries and between stages (lap()),
+    a couple of instructions each, and accumulates over a window of about half a second.
+    Window min / mean / max and per stage means are published through a SeqLock, overrun and xrun counts are atomics.
+    Readers: the editor, and the OSC thread to answer load queries.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "SeqLock.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+class LoadMeter
+{
+    public:
+
+        enum Stage { smoothing, delay, filter, numStages };
+
+        struct Stats
+        {
+            float minLoad = 0.0f;                       // over the last window
+            float meanLoad = 0.0f;
+            float maxLoad = 0.0f;
+            std::array<float, numStages> stageLoad {};  // mean per stage, same unit
+            juce::uint32 overruns = 0;                  // since prepare
+            juce::uint32 xruns = 0;
+        };
+
+        void prepare(double newSampleRate, int maximumBlockSize)
+        {
+            sampleRate = newSampleRate;
+            maxBlockSize = juce::jmax(1, maximumBlockSize);
+            overruns.store(0);
+            xruns.store(0);
+            resetWindow();
+
+            // the cycle counter rate is measured against the high resolution clock over the first windows
+            calibrationTicks = juce::Time::getHighResolutionTicks();
+            calibrationCycles = readCycleCounter();
+            cyclesPerSecond = 0.0;
+            lastBlockStart = 0;
+        }
+
+        /* audio thread, first thing in processBlock */
+        void beginBlock(int numSamples) noexcept
+        {
+            const auto now = readCycleCounter();
+
+            // the host called us late: the gap since the previous block is more than twice the device period.
+            // measured against the prepared block size, not the previous block: a host that splits a period
+            // (automation, loop points) calls the second part one short block later, and a whole period after that.
+            // gaps longer than maxGapSeconds are the stream being stopped, not dropouts
+            if (lastBlockStart != 0 && cyclesPerSecond > 0.0)
+            {
+                const auto gap = (double)(now - lastBlockStart) / cyclesPerSecond;
+                const auto expected = (double)juce::jmax(maxBlockSize, lastBlockSize) / sampleRate;
+
+                if (gap > 2.0 * expected && gap < maxGapSeconds)
+                    xruns.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            blockStart = lastLap = lastBlockStart = now;
+            lastBlockSize = numSamples;
+        }
+
+        /* attributes the time since the previous lap (or the start of the block) to stage */
+        void lap(Stage stage) noexcept
+        {
+            const auto now = readCycleCounter();
+            blockStageCycles[(size_t)stage] += now - lastLap;
+            lastLap = now;
+        }
+
+        /* audio thread, last thing in processBlock */
+        void endBlock() noexcept
+        {
+            const auto elapsed = readCycleCounter() - blockStart;
+
+            // per sample cost, converted to a load when the window is published (the cycle rate may not be known yet)
+            const auto cyclesPerSample = (double)elapsed / (double)juce::jmax(1, lastBlockSize);
+            windowMin = juce::jmin(windowMin, cyclesPerSample);
+            windowMax = juce::jmax(windowMax, cyclesPerSample);
+            windowCycles += elapsed;
+            windowSamples += lastBlockSize;
+
+            for (size_t stage = 0; stage < numStages; ++stage)
+            {
+                windowStageCycles[stage] += blockStageCycles[stage];
+                blockStageCycles[stage] = 0;
+            }
+
+            if (cyclesPerSecond > 0.0 && cyclesPerSample * sampleRate > cyclesPerSecond)
+                overruns.fetch_add(1, std::memory_order_relaxed);
+
+            if (windowSamples >= (juce::int64)(windowSeconds * sampleRate))
+                publishWindow();
+        }
+
+        /* any thread. false until the first window was published */
+        bool getStats(Stats& stats) const noexcept
+        {
+            if (! published.read(stats))
+                return false;
+
+            stats.overruns = overruns.load(std::memory_order_relaxed);
+            stats.xruns = xruns.load(std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+
+        static inline juce::uint64 readCycleCounter() noexcept
+        {
+           #if JUCE_INTEL
+            return (juce::uint64)__rdtsc();
+           #elif JUCE_ARM && JUCE_64BIT && ! JUCE_MSVC
+            juce::uint64 value;
+            asm volatile ("mrs %0, cntvct_el0" : "=r" (value));
+            return value;
+           #else
+            return (juce::uint64)juce::Time::getHighResolutionTicks();
+           #endif
+        }
+
+        void publishWindow() noexcept
+        {
+            // cycle counter rate, refined at every window since prepare
+            const auto ticks = juce::Time::getHighResolutionTicks();
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(ticks - calibrationTicks);
+
+            if (seconds > 0.0)
+                cyclesPerSecond = (double)(readCycleCounter() - calibrationCycles) / seconds;
+
+            if (cyclesPerSecond > 0.0)
+            {
+                // load = cycles per sample * samples per second / cycles per second
+                const auto toLoad = sampleRate / cyclesPerSecond;
+                const auto samples = (double)windowSamples;
+
+                Stats stats;
+                stats.minLoad = (float)(windowMin * toLoad);
+                stats.meanLoad = (float)((double)windowCycles / samples * toLoad);
+                stats.maxLoad = (float)(windowMax * toLoad);
+
+                for (size_t stage = 0; stage < numStages; ++stage)
+                    stats.stageLoad[stage] = (float)((double)windowStageCycles[stage] / samples * toLoad);
+
+                published.write(stats);
+            }
+
+            resetWindow();
+        }
+
+        void resetWindow() noexcept
+        {
+            windowMin = std::numeric_limits<double>::max();
+            windowMax = 0.0;
+            windowCycles = 0;
+            windowSamples = 0;
+            windowStageCycles.fill(0);
+            blockStageCycles.fill(0);
+        }
+
+        static constexpr double windowSeconds = 0.5;
+        static constexpr double maxGapSeconds = 0.5;
+
+        double sampleRate = 44100.0;
+        int maxBlockSize = 512;
+
+        /* audio thread only */
+        juce::int64 calibrationTicks = 0;
+        juce::uint64 calibrationCycles = 0;
+        double cyclesPerSecond = 0.0;
+
+        juce::uint64 blockStart = 0;
+        juce::uint64 lastLap = 0;
+        juce::uint64 lastBlockStart = 0;
+        int lastBlockSize = 0;
+        std::array<juce::uint64, numStages> blockStageCycles {};
+
+        double windowMin = 0.0;
+        double windowMax = 0.0;
+        juce::uint64 windowCycles = 0;
+        juce::int64 windowSamples = 0;
+        std::array<juce::uint64, numStages> windowStageCycles {};
+
+        /* readers */
+        SeqLock<Stats> published;
+        std::atomic<juce::uint32> overruns { 0 };
+        std::atomic<juce::uint32> xruns { 0 };
+};
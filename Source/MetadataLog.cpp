@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+    MetadataLog.cpp
+    Created: 24 Oct 2026 10:48:03am
+    Author:  regnier
+    Brief: Memory mapped recorder / player of the source metadata.
+
+  ==============================================================================
+*/
+
+#include "MetadataLog.h"
+
+double MetadataLog::getTransportSeconds(juce::AudioPlayHead* playHead, double sampleRate, bool& isPlaying)
+{
+    isPlaying = false;
+
+    if (playHead == nullptr)
+        return -1.0;
+
+    const auto position = playHead->getPosition();
+
+    if (! position.hasValue())
+        return -1.0;
+
+    isPlaying = position->getIsPlaying();
+
+    if (const auto seconds = position->getTimeInSeconds())
+        return *seconds;
+
+    if (const auto samples = position->getTimeInSamples())
+        return (double)*samples / sampleRate;
+
+    return -1.0;
+}
+
+//==============================================================================
+bool MetadataLogWriter::open(const juce::File& file)
+{
+    close();
+
+    if (! file.deleteFile())
+        return false;
+
+    stream = std::make_unique<juce::FileOutputStream>(file);
+
+    if (stream->failedToOpen())
+    {
+        stream.reset();
+        return false;
+    }
+
+    // the record count is only known at the end: 0 until then
+    MetadataLog::Header header {};
+    std::memcpy(header.magic, MetadataLog::kMagic, sizeof(header.magic));
+    header.version = MetadataLog::kVersion;
+    header.recordSize = (juce::uint32)sizeof(MetadataLog::Record);
+    stream->write(&header, sizeof(header));
+    stream->flush();
+
+    logFile = file;
+    numRecords = 0;
+    lastTime = 0.0;
+    currentChunk = -1;
+    chunkStartTimes.clear();
+    return true;
+}
+
+void MetadataLogWriter::close()
+{
+    if (stream == nullptr)
+        return;
+
+    mappedChunk.reset();
+    currentChunk = -1;
+
+    MetadataLog::Header header {};
+    std::memcpy(header.magic, MetadataLog::kMagic, sizeof(header.magic));
+    header.version = MetadataLog::kVersion;
+    header.recordSize = (juce::uint32)sizeof(MetadataLog::Record);
+    header.numRecords = numRecords;
+
+    stream->setPosition(0);
+    stream->write(&header, sizeof(header));
+
+    // the last chunk was sized in full
+    stream->setPosition((juce::int64)sizeof(MetadataLog::Header) + numRecords * (juce::int64)sizeof(MetadataLog::Record));
+    stream->truncate();
+    stream.reset();
+}
+
+bool MetadataLogWriter::mapChunk(int chunk)
+{
+    mappedChunk.reset();
+    currentChunk = -1;
+
+    const auto chunkBytes = chunkRecords * (juce::int64)sizeof(MetadataLog::Record);
+    const auto start = (juce::int64)sizeof(MetadataLog::Header) + chunk * chunkBytes;
+
+    // grow the file to hold the whole chunk (sparse on most file systems), the mapping cannot go past its end
+    if (logFile.getSize() < start + chunkBytes)
+    {
+        stream->setPosition(start + chunkBytes - 1);
+        stream->writeByte(0);
+        stream->flush();
+    }
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(logFile, juce::Range<juce::int64>(start, start + chunkBytes),
+                                                           juce::MemoryMappedFile::readWrite);
+
+    if (mapped->getData() == nullptr)
+        return false;
+
+    mappedChunk = std::move(mapped);
+    currentChunk = chunk;
+    return true;
+}
+
+MetadataLog::Record* MetadataLogWriter::recordAt(juce::int64 index) const noexcept
+{
+    // the mapping starts at the page boundary before the chunk
+    const auto offset = (juce::int64)sizeof(MetadataLog::Header) + index * (juce::int64)sizeof(MetadataLog::Record);
+    return reinterpret_cast<MetadataLog::Record*>(static_cast<char*>(mappedChunk->getData()) + (offset - mappedChunk->getRange().getStart()));
+}
+
+void MetadataLogWriter::append(const SourceMetadata& source, double transportSeconds)
+{
+    if (stream == nullptr)
+        return;
+
+    if (numRecords > 0 && transportSeconds < lastTime - rewindThresholdSeconds)
+        rewindTo(transportSeconds);
+
+    const auto chunk = (int)(numRecords / chunkRecords);
+
+    if (chunk != currentChunk && ! mapChunk(chunk))
+        return;
+
+    if (numRecords % chunkRecords == 0)
+    {
+        chunkStartTimes.resize((size_t)chunk);
+        chunkStartTimes.push_back(transportSeconds);
+    }
+
+    auto* record = recordAt(numRecords);
+    record->timeSeconds = transportSeconds;
+    record->index = source.index;
+    record->type = source.type;
+    record->azimuth = source.azimuth;
+    record->elevation = source.elevation;
+    record->distance = source.distance;
+    record->volume = source.volume;
+
+    ++numRecords;
+    lastTime = transportSeconds;
+}
+
+void MetadataLogWriter::rewindTo(double transportSeconds)
+{
+    // last chunk starting at or before the time, then the first record at or after it in that chunk
+    int chunk = 0;
+
+    while (chunk + 1 < (int)chunkStartTimes.size() && chunkStartTimes[(size_t)chunk + 1] <= transportSeconds)
+        ++chunk;
+
+    if (chunk != currentChunk && ! mapChunk(chunk))
+        return;
+
+    const auto first = (juce::int64)chunk * chunkRecords;
+    const auto last = juce::jmin(numRecords, first + chunkRecords);
+    const auto* begin = recordAt(first);
+
+    const auto* found = std::lower_bound(begin, begin + (last - first), transportSeconds,
+                                         [](const MetadataLog::Record& record, double time) { return record.timeSeconds < time; });
+
+    numRecords = first + (found - begin);
+    chunkStartTimes.resize((size_t)chunk + 1);
+}
+
+//==============================================================================
+MetadataLogPlayer::MetadataLogPlayer()
+    : juce::Thread("IOSONO log prefetch")
+{
+}
+
+MetadataLogPlayer::~MetadataLogPlayer()
+{
+    stopThread(1000);
+}
+
+bool MetadataLogPlayer::open(const juce::File& file)
+{
+    stopThread(1000);
+    records = nullptr;
+    numRecords = 0;
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto size = (juce::int64)mapped->getSize();
+
+    if (mapped->getData() == nullptr || size < (juce::int64)sizeof(MetadataLog::Header))
+        return false;
+
+    MetadataLog::Header header;
+    std::memcpy(&header, mapped->getData(), sizeof(header));
+
+    if (std::memcmp(header.magic, MetadataLog::kMagic, sizeof(header.magic)) != 0
+        || header.version != MetadataLog::kVersion || header.recordSize != sizeof(MetadataLog::Record))
+        return false;
+
+    // a recording that did not stop properly has no count, but its unused tail is zeroed: time 0, index 0
+    const auto available = (size - (juce::int64)sizeof(MetadataLog::Header)) / (juce::int64)sizeof(MetadataLog::Record);
+    mappedFile = std::move(mapped);
+    records = reinterpret_cast<const MetadataLog::Record*>(static_cast<const char*>(mappedFile->getData()) + sizeof(MetadataLog::Header));
+    numRecords = header.numRecords > 0 ? juce::jmin(header.numRecords, available) : available;
+
+    if (header.numRecords == 0)
+        while (numRecords > 0 && records[numRecords - 1].index == 0)
+            --numRecords;
+
+    cursor = 0;
+    currentTime = -1.0;
+    known.fill(false);
+    prefetchCursor.store(0);
+    startThread(juce::Thread::Priority::low);
+    return true;
+}
+
+void MetadataLogPlayer::apply(const MetadataLog::Record& record) noexcept
+{
+    if (record.index < 1 || record.index > MetadataSender::maxSources)
+        return;
+
+    states[(size_t)record.index - 1] = record;
+    known[(size_t)record.index - 1] = true;
+}
+
+void MetadataLogPlayer::seek(double transportSeconds) noexcept
+{
+    known.fill(false);
+
+    // first record after the time, then back over the window: the latest record of each source wins
+    cursor = std::upper_bound(records, records + numRecords, transportSeconds,
+                              [](double time, const MetadataLog::Record& record) { return time < record.timeSeconds; }) - records;
+
+    for (auto i = cursor - 1; i >= 0 && records[i].timeSeconds >= transportSeconds - seekWindowSeconds; --i)
+    {
+        const auto index = records[i].index;
+
+        if (index >= 1 && index <= MetadataSender::maxSources && ! known[(size_t)index - 1])
+            apply(records[i]);
+    }
+}
+
+void MetadataLogPlayer::advanceTo(double transportSeconds) noexcept
+{
+    if (numRecords == 0)
+        return;
+
+    // playing on: the records in between. anything else (locate, loop, first block): look it up
+    if (currentTime < 0.0 || transportSeconds < currentTime || transportSeconds > currentTime + seekWindowSeconds)
+    {
+        seek(transportSeconds);
+    }
+    else
+    {
+        while (cursor < numRecords && records[cursor].timeSeconds <= transportSeconds)
+            apply(records[cursor++]);
+    }
+
+    currentTime = transportSeconds;
+    prefetchCursor.store(cursor, std::memory_order_relaxed);
+}
+
+bool MetadataLogPlayer::getSource(int index, SourceMetadata& source) const noexcept
+{
+    if (index < 1 || index > MetadataSender::maxSources || ! known[(size_t)index - 1])
+        return false;
+
+    const auto& record = states[(size_t)index - 1];
+    source.index = record.index;
+    source.type = record.type;
+    source.azimuth = record.azimuth;
+    source.elevation = record.elevation;
+    source.distance = record.distance;
+    source.volume = record.volume;
+    return true;
+}
+
+void MetadataLogPlayer::run()
+{
+    const auto* bytes = static_cast<const char*>(mappedFile->getData());
+    const auto size = (juce::int64)mappedFile->getSize();
+    constexpr juce::int64 pageSize = 4096;
+
+    while (! threadShouldExit())
+    {
+        // touch the pages ahead of the play position, so that they are resident when the audio thread gets there
+        const auto start = (juce::int64)sizeof(MetadataLog::Header) + prefetchCursor.load(std::memory_order_relaxed) * (juce::int64)sizeof(MetadataLog::Record);
+        const auto end = juce::jmin(size, start + prefetchBytes);
+        char sum = 0;
+
+        for (auto offset = start; offset < end; offset += pageSize)
+            sum = (char)(sum + *(const volatile char*)(bytes + offset));
+
+        juce::ignoreUnused(sum);
+        wait(100);
+    }
+}
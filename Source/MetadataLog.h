@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    MetadataLog.h
+    Created: 24 Oct 2026 10:48:03am
+    @Author:  regnier
+    @Brief: Binary log of the source metadata, to capture a show's movements and replay them without the automation.
+    File: a 32 byte header, then 32 byte records (transport time, index, type, azimuth, elevation, distance, volume),
+    in transport time order. Both sides go through memory mapped files, so an hour of 64 sources (a few hundred MB)
+    is never loaded as a whole:
+    --> MetadataLogWriter appends on the OSC thread, mapping the file chunk by chunk. When the transport jumps back
+        it rewinds to that time and records over what follows (punch-in)
+    --> MetadataLogPlayer maps the whole file read-only and follows the transport, a background thread touches
+        the pages ahead of the play position so that the audio thread does not wait for the disk
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "MetadataSender.h"
+
+namespace MetadataLog
+{
+    /* little endian on every platform we build for */
+    struct Record
+    {
+        double timeSeconds;     // host transport position of the block
+        juce::int32 index;      // 1 to 64
+        juce::int32 type;
+        float azimuth;          // IOSONO convention, as sent
+        float elevation;
+        float distance;
+        float volume;
+    };
+
+    struct Header
+    {
+        char magic[8];          // "IOSOLOG1"
+        juce::uint32 version;
+        juce::uint32 recordSize;
+        juce::int64 numRecords; // written when the recording stops, 0 if the writer crashed (the readers then use the file size)
+        juce::int64 reserved;
+    };
+
+    static_assert(sizeof(Record) == 32, "file format");
+    static_assert(sizeof(Header) == 32, "file format");
+
+    static constexpr juce::uint32 kVersion = 1;
+    static const char kMagic[8] = { 'I', 'O', 'S', 'O', 'L', 'O', 'G', '1' };
+
+    /* audio thread: host transport position in seconds, -1 when the host does not give one */
+    double getTransportSeconds(juce::AudioPlayHead* playHead, double sampleRate, bool& isPlaying);
+}
+
+/* OSC thread only */
+class MetadataLogWriter
+{
+    public:
+
+        ~MetadataLogWriter() { close(); }
+
+        /* creates (or replaces) the file */
+        bool open(const juce::File& file);
+
+        /* writes the record count and trims the file to its content */
+        void close();
+
+        bool isOpen() const noexcept { return stream != nullptr; }
+
+        /* records must come in transport order: a time more than rewindThresholdSeconds before the last one
+           is a transport jump back, the log is rewound to it first */
+        void append(const SourceMetadata& source, double transportSeconds);
+
+        juce::int64 getNumRecords() const noexcept { return numRecords; }
+
+    private:
+
+        static constexpr juce::int64 chunkRecords = 1 << 19;   // 16 MB
+        static constexpr double rewindThresholdSeconds = 0.1;
+
+        bool mapChunk(int chunk);
+        void rewindTo(double transportSeconds);
+        MetadataLog::Record* recordAt(juce::int64 index) const noexcept;
+
+        juce::File logFile;
+        std::unique_ptr<juce::FileOutputStream> stream;     // sizes the file, and writes the header
+        std::unique_ptr<juce::MemoryMappedFile> mappedChunk;
+        int currentChunk = -1;
+        juce::int64 numRecords = 0;
+        double lastTime = 0.0;
+
+        /* time of the first record of each chunk, to find where to rewind */
+        std::vector<double> chunkStartTimes;
+};
+
+class MetadataLogPlayer : private juce::Thread
+{
+    public:
+
+        MetadataLogPlayer();
+        ~MetadataLogPlayer() override;
+
+        /* message thread. false if the file is not a log */
+        bool open(const juce::File& file);
+
+        juce::int64 getNumRecords() const noexcept { return numRecords; }
+        double getLengthSeconds() const noexcept { return numRecords > 0 ? records[numRecords - 1].timeSeconds : 0.0; }
+
+        /* audio thread, once per block: moves to the transport time. sequential play reads the records in between,
+           a jump looks the time up and rebuilds every source from the records of the seekWindowSeconds before it */
+        void advanceTo(double transportSeconds) noexcept;
+
+        /* audio thread: last state of the source at the current time. false if it was not recorded (yet) */
+        bool getSource(int index, SourceMetadata& source) const noexcept;
+
+    private:
+
+        /* the sender keep-alive is 1 s, so every recorded source has a record in any 1 s window */
+        static constexpr double seekWindowSeconds = 1.5;
+        static constexpr juce::int64 prefetchBytes = 4 << 20;
+
+        void seek(double transportSeconds) noexcept;
+        void apply(const MetadataLog::Record& record) noexcept;
+        void run() override;
+
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+        const MetadataLog::Record* records = nullptr;
+        juce::int64 numRecords = 0;
+
+        /* audio thread */
+        juce::int64 cursor = 0;     // next record to apply
+        double currentTime = -1.0;
+        std::array<MetadataLog::Record, MetadataSender::maxSources> states {};
+        std::array<bool, MetadataSender::maxSources> known {};
+
+        /* read by the prefetch thread */
+        std::atomic<juce::int64> prefetchCursor { 0 };
+};
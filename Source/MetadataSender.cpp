@@ -0,0 +1,160 @@
+/*
+  ==============================================================================
+
+    MetadataSender.cpp
+    Created: 18 Oct 2026 9:14:52am
+    Author:  regnier
+    Brief: OSC sender for the IOSONO source metadata, with change detection and keep-alive.
+
+  ==============================================================================
+*/
+
+#include "MetadataSender.h"
+#include "SharedMetadataRing.h"
+
+MetadataSender::MetadataSender() = default;
+MetadataSender::~MetadataSender() = default;
+
+bool MetadataSender::connect(const juce::String& targetHostName, int targetPortNumber)
+{
+    invalidate();
+    return oscMessageSender.connect(targetHostName, targetPortNumber);
+}
+
+void MetadataSender::setSharedMemory(std::unique_ptr<SharedMetadataRing::Writer> writer, bool sendUdp)
+{
+    invalidate();
+    sharedMemory = std::move(writer);
+    setSharedMemoryUdp(sendUdp);
+}
+
+void MetadataSender::invalidate()
+{
+    for (auto& last : lastSent)
+        last.valid = false;
+}
+
+bool MetadataSender::hasChanged(const SourceMetadata& last, const SourceMetadata& source) const
+{
+    return source.type != last.type || changeInDeadBands(last, source) > 1.0f;
+}
+
+float MetadataSender::changeInDeadBands(const SourceMetadata& last, const SourceMetadata& source) const
+{
+    // azimuth wraps around at 360
+    auto azimuthDelta = std::abs(source.azimuth - last.azimuth);
+    azimuthDelta = juce::jmin(azimuthDelta, 360.0f - azimuthDelta);
+
+    // a 0 threshold means any change
+    constexpr float minimumThreshold = 1.0e-9f;
+
+    return juce::jmax(azimuthDelta / juce::jmax(minimumThreshold, thresholds.azimuth),
+                      std::abs(source.elevation - last.elevation) / juce::jmax(minimumThreshold, thresholds.elevation),
+                      std::abs(source.distance - last.distance) / juce::jmax(minimumThreshold, thresholds.distance),
+                      std::abs(source.volume - last.volume) / juce::jmax(minimumThreshold, thresholds.volume));
+}
+
+float MetadataSender::getUrgency(const SourceMetadata& source, double nowMs) const
+{
+    if (source.index < 1 || source.index > maxSources)
+        return 0.0f;
+
+    const auto& last = lastSent[(size_t)(source.index - 1)];
+
+    if (! last.valid || source.type != last.type)
+        return kMustSend;
+
+    const auto change = changeInDeadBands(last.metadata, source);
+    return nowMs - last.timeMs >= keepAliveMs ? juce::jmax(1.0f, change) : change;
+}
+
+double MetadataSender::getMsSinceSent(const SourceMetadata& source, double nowMs) const
+{
+    if (source.index < 1 || source.index > maxSources)
+        return 0.0;
+
+    const auto& last = lastSent[(size_t)(source.index - 1)];
+    return last.valid ? nowMs - last.timeMs : std::numeric_limits<double>::max();
+}
+
+bool MetadataSender::send(const SourceMetadata& source, double nowMs)
+{
+    if (source.index < 1 || source.index > maxSources)
+        return false;
+
+    auto& last = lastSent[(size_t)(source.index - 1)];
+
+    if (last.valid && ! hasChanged(last.metadata, source) && nowMs - last.timeMs < keepAliveMs)
+        return false;
+
+    bool sent = false;
+
+    if (sharedMemory != nullptr)
+    {
+        // same fields as makeMessage
+        SharedMetadataRing::SourceFields fields {};
+        fields.index = source.index;
+        fields.type = source.type;
+        fields.azimuth = source.azimuth;
+        fields.elevation = source.elevation;
+        fields.distance = source.distance;
+        fields.volume = source.volume;
+
+        sharedMemory->write(fields, source.timeMs);
+        sent = true;
+    }
+
+    if (udpEnabled)
+    {
+        if (source.timeMs > 0.0)
+        {
+            juce::OSCBundle bundle(makeTimeTag(source.timeMs));
+            bundle.addElement(makeMessage(source));
+            sent = oscMessageSender.send(bundle) || sent;
+        }
+        else
+        {
+            sent = oscMessageSender.send(makeMessage(source)) || sent;
+        }
+    }
+
+    if (! sent)
+        return false;
+
+    last.metadata = source;
+    last.timeMs = nowMs;
+    last.valid = true;
+    return true;
+}
+
+juce::OSCMessage MetadataSender::makeMessage(const SourceMetadata& source)
+{
+    juce::OSCMessage oscMessage(juce::OSCAddressPattern("/iosono/renderer/version1/src"));
+
+    // IOSONO UDP Packet
+    // /iosono/renderer/version1/src #source_index #source_type #azim #elev #dist #volume 0. 0. 0 0 0. 0
+    oscMessage.addInt32(source.index);
+    oscMessage.addInt32(source.type);
+    oscMessage.addFloat32(source.azimuth);
+    oscMessage.addFloat32(source.elevation);
+    oscMessage.addFloat32(source.distance);
+    oscMessage.addFloat32(source.volume);
+    oscMessage.addFloat32(0.0f);
+    oscMessage.addFloat32(0.0f);
+    oscMessage.addInt32(0);
+    oscMessage.addInt32(0);
+    oscMessage.addFloat32(0.0f);
+    oscMessage.addInt32(0);
+
+    return oscMessage;
+}
+
+juce::OSCTimeTag MetadataSender::makeTimeTag(double unixTimeMs)
+{
+    // NTP: seconds since 1900 in the upper 32 bits, fraction of a second in the lower 32 bits
+    const double seconds = unixTimeMs * 0.001 + 2208988800.0;
+    const auto wholeSeconds = (juce::uint64)seconds;
+    const auto fraction = (juce::uint64)((seconds - (double)wholeSeconds) * 4294967296.0);
+
+    return juce::OSCTimeTag((wholeSeconds << 32) | (fraction & 0xffffffffu));
+}
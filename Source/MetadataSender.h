@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    MetadataSender.h
+    Created: 18 Oct 2026 9:14:52am
+    @Author:  regnier
+    @Brief: OSC sender for the IOSONO source metadata (/iosono/renderer/version1/src).
+    Remembers what was last sent for each source index and only sends again when a value
+    moved beyond a threshold, plus a low rate keep-alive so the renderer never loses a source.
+    Time-stamped sources are sent as a bundle with an NTP time tag, so the renderer can schedule them.
+    Optionally also (or only) written to a shared memory ring, for a renderer / bridge on the same machine.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+namespace SharedMetadataRing { class Writer; }
+
+/* the fields of the /iosono/renderer/version1/src message we actually drive */
+struct SourceMetadata
+{
+    int index = 1;          // 1 to 64
+    int type = 0;           // 0 point source, 1 plane wave
+    float azimuth = 0.0f;   // IOSONO convention, degrees
+    float elevation = 0.0f; // degrees
+    float distance = 1.0f;  // meters
+    float volume = 0.0f;    // linear
+    double timeMs = 0.0;    // when the renderer should apply it, ms since 1970. 0: immediately
+    double transportSeconds = -1.0; // host transport position of the block, -1 when stopped (not recorded)
+};
+
+class MetadataSender
+{
+    public:
+
+        static constexpr int maxSources = 64;
+
+        MetadataSender();
+        ~MetadataSender();
+
+        /* dead-band: a source is re-sent when one of its values moved more than this */
+        struct Thresholds
+        {
+            float azimuth = 0.1f;   // degrees
+            float elevation = 0.1f; // degrees
+            float distance = 0.01f; // meters
+            float volume = 0.001f;  // linear
+        };
+
+        bool connect(const juce::String& targetHostName, int targetPortNumber);
+
+        /* shared memory transport (see SharedMetadataRing.h): sources are written to this ring (created by the caller),
+           and sent over UDP too if sendUdp. nullptr: UDP only. the previous ring is closed here */
+        void setSharedMemory(std::unique_ptr<SharedMetadataRing::Writer> writer, bool sendUdp);
+
+        /* same ring, UDP on or off next to it (always on without a ring) */
+        void setSharedMemoryUdp(bool sendUdp) { udpEnabled = sharedMemory == nullptr || sendUdp; }
+
+        void setThresholds(const Thresholds& newThresholds) { thresholds = newThresholds; }
+        void setKeepAliveInterval(double milliseconds) { keepAliveMs = milliseconds; }
+
+        /* send the source if it changed beyond the thresholds or if its keep-alive is due.
+           returns true if a packet was sent */
+        bool send(const SourceMetadata& source, double nowMs);
+
+        /* for the scheduler: largest change since the source was last sent, in dead-bands (thresholds).
+           at least 1 when its keep-alive is due, kMustSend when it was never sent or changed type */
+        float getUrgency(const SourceMetadata& source, double nowMs) const;
+        double getMsSinceSent(const SourceMetadata& source, double nowMs) const;
+        static constexpr float kMustSend = 1.0e6f;
+
+        /* any other message to the same target (load reports), no change detection */
+        bool sendMessage(const juce::OSCMessage& message) { return oscMessageSender.send(message); }
+
+        /* forget what was sent, next call to send() sends every source */
+        void invalidate();
+
+        static juce::OSCMessage makeMessage(const SourceMetadata& source);
+
+        /* NTP time tag, keeps sub-millisecond precision (juce::OSCTimeTag(juce::Time) is ms only) */
+        static juce::OSCTimeTag makeTimeTag(double unixTimeMs);
+
+    private:
+
+        bool hasChanged(const SourceMetadata& last, const SourceMetadata& source) const;
+        float changeInDeadBands(const SourceMetadata& last, const SourceMetadata& source) const;
+
+        struct LastSent
+        {
+            SourceMetadata metadata;
+            double timeMs = 0.0;
+            bool valid = false;
+        };
+
+        std::array<LastSent, maxSources> lastSent;
+
+        Thresholds thresholds;
+        double keepAliveMs = 1000.0;
+
+        juce::OSCSender oscMessageSender;
+        bool udpEnabled = true;
+        std::unique_ptr<SharedMetadataRing::Writer> sharedMemory;
+};
@@ -0,0 +1,319 @@
+/*
+  ==============================================================================
+
+    MetadataSenderThread.cpp
+    Created: 18 Oct 2026 11:21:05am
+    Author:  regnier
+    Brief: Dedicated OSC network thread fed by lock-free source snapshots, sends them at a motion-dependent rate
+    within a packet budget, answers load queries.
+
+  ==============================================================================
+*/
+
+#include "MetadataSenderThread.h"
+
+MetadataSenderThread::MetadataSenderThread()
+    : juce::Thread("IOSONO OSC sender")
+{
+    for (auto& priority : priorities)
+        priority.store(1.0f);
+}
+
+MetadataSenderThread::~MetadataSenderThread()
+{
+    stop();
+    recorder.close();
+    controlReceiver.removeListener(this);
+    controlReceiver.disconnect();
+}
+
+void MetadataSenderThread::start(bool highPriority)
+{
+    startThread(highPriority ? juce::Thread::Priority::high : juce::Thread::Priority::normal);
+}
+
+void MetadataSenderThread::stop()
+{
+    stopThread(1000);
+}
+
+void MetadataSenderThread::connect(const juce::String& targetHostName, int targetPortNumber)
+{
+    const juce::ScopedLock sl(connectionLock);
+    pendingHostName = targetHostName;
+    pendingPortNumber = targetPortNumber;
+    connectionPending = true;
+}
+
+bool MetadataSenderThread::useSharedMemory(const juce::String& name, bool alsoSendUdp)
+{
+    {
+        const juce::ScopedLock sl(connectionLock);
+
+        // this ring already: creating it again would be refused, it is ours
+        if (name.isNotEmpty() && name == sharedMemoryName)
+        {
+            pendingSharedMemoryUdp = alsoSendUdp;
+            sharedMemoryPending = true;
+            return true;
+        }
+    }
+
+    // created outside the lock, the sender thread takes it in its next round
+    std::unique_ptr<SharedMetadataRing::Writer> writer;
+
+    if (name.isNotEmpty())
+    {
+        writer = std::make_unique<SharedMetadataRing::Writer>();
+
+        if (! writer->create(name.toStdString()))
+            writer.reset();
+    }
+
+    const auto created = name.isEmpty() || writer != nullptr;
+
+    const juce::ScopedLock sl(connectionLock);
+    sharedMemoryName = created ? name : juce::String();
+    pendingSharedMemory = std::move(writer);
+    pendingSharedMemoryUdp = created ? alsoSendUdp : true;
+    sharedMemoryPending = true;
+    replaceSharedMemory = true;
+    return created;
+}
+
+void MetadataSenderThread::startRecording(const juce::File& file)
+{
+    const juce::ScopedLock sl(connectionLock);
+    pendingRecordingFile = file;
+    recordingPending = true;
+}
+
+void MetadataSenderThread::stopRecording()
+{
+    startRecording({});
+}
+
+void MetadataSenderThread::applyPendingConnection()
+{
+    juce::String hostName;
+    std::unique_ptr<SharedMetadataRing::Writer> sharedMemory;
+    juce::File recordingFile;
+    int portNumber = 0;
+    bool connectNow = false, sharedMemoryNow = false, sharedMemoryUdp = true, replaceNow = false, recordingNow = false;
+
+    {
+        const juce::ScopedLock sl(connectionLock);
+
+        if (! connectionPending && ! sharedMemoryPending && ! recordingPending)
+            return;
+
+        hostName = pendingHostName;
+        portNumber = pendingPortNumber;
+        connectNow = connectionPending;
+        connectionPending = false;
+
+        sharedMemory = std::move(pendingSharedMemory);
+        sharedMemoryUdp = pendingSharedMemoryUdp;
+        sharedMemoryNow = sharedMemoryPending;
+        replaceNow = replaceSharedMemory;
+        sharedMemoryPending = false;
+        replaceSharedMemory = false;
+
+        recordingFile = pendingRecordingFile;
+        recordingNow = recordingPending;
+        recordingPending = false;
+    }
+
+    if (connectNow)
+        metadataSender.connect(hostName, portNumber);
+
+    // the ring being replaced is closed here, outside the lock
+    if (sharedMemoryNow && replaceNow)
+        metadataSender.setSharedMemory(std::move(sharedMemory), sharedMemoryUdp);
+    else if (sharedMemoryNow)
+        metadataSender.setSharedMemoryUdp(sharedMemoryUdp);
+
+    if (recordingNow)
+    {
+        recorder.close();
+
+        if (recordingFile != juce::File())
+            recorder.open(recordingFile);
+    }
+}
+
+void MetadataSenderThread::applyListenPort()
+{
+    const auto port = requestedListenPort.load();
+
+    if (port == listenPort)
+        return;
+
+    controlReceiver.removeListener(this);
+    controlReceiver.disconnect();
+    listenPort = port;
+
+    // port taken (another instance with the same INDEX): stay deaf, the request is not retried until it changes
+    if (port > 0 && controlReceiver.connect(port))
+        controlReceiver.addListener(this);
+}
+
+static float argumentToFloat(const juce::OSCArgument& argument)
+{
+    if (argument.isFloat32())  return argument.getFloat32();
+    if (argument.isInt32())    return (float)argument.getInt32();
+    return 0.0f;
+}
+
+void MetadataSenderThread::oscMessageReceived(const juce::OSCMessage& message)
+{
+    const auto address = message.getAddressPattern().toString();
+
+    // /iosono/position #azim #elev #dist, usual conventions (same as the AZIM / ELEV / DIST parameters). hot path, lock-free
+    if (address == "/iosono/position")
+    {
+        auto* input = positionInput.load();
+
+        if (input != nullptr && message.size() >= 3)
+        {
+            PositionInput::Position position;
+            position.azimuth = argumentToFloat(message[0]);
+            position.elevation = argumentToFloat(message[1]);
+            position.distance = argumentToFloat(message[2]);
+            position.timeMs = juce::Time::getMillisecondCounterHiRes();
+            input->push(position);
+        }
+
+        return;
+    }
+
+    // /iosono/load/query [reply host] [reply port]
+    if (address != "/iosono/load/query")
+        return;
+
+    {
+        const juce::ScopedLock sl(connectionLock);
+
+        if (message.size() >= 2 && message[0].isString() && message[1].isInt32())
+        {
+            replyHostName = message[0].getString();
+            replyPortNumber = message[1].getInt32();
+        }
+        else
+        {
+            replyHostName = {};
+            replyPortNumber = 0;
+        }
+    }
+
+    // answered at the next round, at most one send interval later
+    loadQueryPending.store(true);
+}
+
+void MetadataSenderThread::answerLoadQuery(const SourceMetadata& firstSource)
+{
+    if (! loadQueryPending.exchange(false))
+        return;
+
+    const auto* meter = loadMeter.load();
+    LoadMeter::Stats stats;
+
+    if (meter == nullptr || ! meter->getStats(stats))
+        return;
+
+    // /iosono/load #source_index #mean #min #max #smoothing #delay #filter #overruns #xruns, loads as a fraction of the block budget
+    juce::OSCMessage reply(juce::OSCAddressPattern("/iosono/load"));
+    reply.addInt32(firstSource.index);
+    reply.addFloat32(stats.meanLoad);
+    reply.addFloat32(stats.minLoad);
+    reply.addFloat32(stats.maxLoad);
+    reply.addFloat32(stats.stageLoad[LoadMeter::smoothing]);
+    reply.addFloat32(stats.stageLoad[LoadMeter::delay]);
+    reply.addFloat32(stats.stageLoad[LoadMeter::filter]);
+    reply.addInt32((juce::int32)stats.overruns);
+    reply.addInt32((juce::int32)stats.xruns);
+
+    juce::String hostName;
+    int portNumber = 0;
+
+    {
+        const juce::ScopedLock sl(connectionLock);
+        hostName = replyHostName;
+        portNumber = replyPortNumber;
+    }
+
+    if (hostName.isEmpty() || portNumber <= 0)
+    {
+        metadataSender.sendMessage(reply);
+        return;
+    }
+
+    if (hostName != connectedReplyHostName || portNumber != connectedReplyPortNumber)
+    {
+        if (! replySender.connect(hostName, portNumber))
+            return;
+
+        connectedReplyHostName = hostName;
+        connectedReplyPortNumber = portNumber;
+    }
+
+    replySender.send(reply);
+}
+
+void MetadataSenderThread::run()
+{
+    // absolute deadlines, so that the period does not drift with the time spent sending
+    auto nextRound = juce::Time::getMillisecondCounterHiRes();
+
+    while (! threadShouldExit())
+    {
+        applyPendingConnection();
+        applyListenPort();
+
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        const auto numSlots = activeSlots.load();
+        SourceMetadata firstSource;
+
+        scheduler.setMaxRate(maxSendRate.load());
+        scheduler.beginRound();
+
+        for (int slot = 0; slot < numSlots; ++slot)
+        {
+            auto& source = snapshots[(size_t)slot];
+            scheduler.setPriority(slot, priorities[(size_t)slot].load(std::memory_order_relaxed));
+
+            // nothing published yet, or the writer kept interfering: try again next round
+            if (slots[(size_t)slot].read(source))
+            {
+                scheduler.consider(slot, metadataSender.getUrgency(source, now), metadataSender.getMsSinceSent(source, now));
+
+                if (slot == 0)
+                    firstSource = source;
+            }
+        }
+
+        scheduler.sendDue(now, [this, now](int slot)
+            {
+                const auto& source = snapshots[(size_t)slot];
+
+                if (! metadataSender.send(source, now))
+                    return false;
+
+                // what went out is what the renderer got: the log replays the same dead-banded stream
+                if (recorder.isOpen() && source.transportSeconds >= 0.0)
+                    recorder.append(source, source.transportSeconds);
+
+                return true;
+            });
+
+        answerLoadQuery(firstSource);
+
+        nextRound += scheduler.getRoundIntervalMs();
+        const auto remaining = nextRound - juce::Time::getMillisecondCounterHiRes();
+
+        if (remaining <= 0.0)
+            nextRound = juce::Time::getMillisecondCounterHiRes(); // late: skip instead of bursting
+        else
+            wait((int)std::ceil(remaining));
+    }
+}
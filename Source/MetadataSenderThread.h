@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    MetadataSenderThread.h
+    Created: 18 Oct 2026 11:21:05am
+    @Author:  regnier
+    @Brief: Dedicated OSC network thread. The audio side publishes the latest state of each source
+    into a SeqLock slot, the thread wakes up at the maximum send rate and hands the snapshots that are due to the
+    MetadataSender, as picked by the SendScheduler (motion-dependent rate, heartbeat, packet budget).
+    Send timing no longer depends on the load of the message thread (editor repaints, host dialogs...).
+    Also listens on a control port for load queries (/iosono/load/query), answered from the same thread,
+    and for positions (/iosono/position), handed to a PositionInput straight from the receiver thread.
+    While recording, each snapshot that goes out with the transport playing is appended to a MetadataLog.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "MetadataSender.h"
+#include "SeqLock.h"
+#include "LoadMeter.h"
+#include "PositionInput.h"
+#include "SendScheduler.h"
+#include "MetadataLog.h"
+
+class MetadataSenderThread : private juce::Thread,
+    private juce::OSCReceiver::Listener<juce::OSCReceiver::RealtimeCallback>
+{
+    public:
+
+        MetadataSenderThread();
+        ~MetadataSenderThread() override;
+
+        /* highPriority puts the thread above normal threads, so that it is not delayed by UI work */
+        void start(bool highPriority = true);
+        void stop();
+
+        /* applied by the sender thread before its next round */
+        void connect(const juce::String& targetHostName, int targetPortNumber);
+
+        /* shared memory ring with this name (see SharedMetadataRing.h), plus UDP if alsoSendUdp. empty name: UDP only.
+           the ring is created here, not real-time: never from the audio thread. used by the sender thread from its next round.
+           false if it cannot be created (the name is held by another running writer, no shared memory...): UDP only then */
+        bool useSharedMemory(const juce::String& name, bool alsoSendUdp);
+
+        /* records the sent metadata to this file (see MetadataLog.h) while the transport plays, until stopRecording.
+           applied by the sender thread before its next round */
+        void startRecording(const juce::File& file);
+        void stopRecording();
+
+        /* control port, (re)opened by the sender thread before its next round. 0 closes it. lock-free */
+        void listen(int portNumber) noexcept { requestedListenPort.store(portNumber); }
+
+        /* answers /iosono/load/query with the stats of this meter, if set. must outlive the thread */
+        void setLoadMeter(const LoadMeter* meter) noexcept { loadMeter.store(meter); }
+
+        /* /iosono/position #azim #elev #dist are pushed to this input, if set. must outlive the thread */
+        void setPositionInput(PositionInput* input) noexcept { positionInput.store(input); }
+
+        /* a moving source is sent each time it moved by a dead-band, at most maxRate times per second.
+           a static one only gets the 1 s keep-alive. applied at the next round */
+        void setMaxSendRate(double hz) noexcept { maxSendRate.store(juce::jlimit(1.0, 1000.0, hz)); }
+
+        /* packets per second for all the sources of all the instances of this process (SendScheduler.h: PacketBudget).
+           when short, the most urgent sources go first, weighted by their priority (1 by default, 0 to 10: the PRIORITY parameter) */
+        static void setPacketBudget(double packetsPerSecond) noexcept { PacketBudget::getInstance().setRate(packetsPerSecond); }
+        void setPriority(int slot, float priority) noexcept { priorities[(size_t)slot].store(priority); }
+
+        /* audio / parameter side, lock-free. slot is 0 to MetadataSender::maxSources - 1 */
+        void publish(int slot, const SourceMetadata& source) noexcept { slots[(size_t)slot].write(source); }
+
+        /* the last state published in a slot, any thread, lock-free (e.g. the editor drawing the sources). false if none yet */
+        bool readLatest(int slot, SourceMetadata& source) const noexcept { return slots[(size_t)slot].read(source); }
+        void setNumSlots(int numSlots) noexcept { activeSlots.store(juce::jlimit(0, MetadataSender::maxSources, numSlots)); }
+
+    private:
+
+        void run() override;
+        void applyPendingConnection();
+        void applyListenPort();
+        void answerLoadQuery(const SourceMetadata& firstSource);
+
+        /* receiver thread */
+        void oscMessageReceived(const juce::OSCMessage& message) override;
+
+        std::array<SeqLock<SourceMetadata>, MetadataSender::maxSources> slots;
+        std::atomic<int> activeSlots { 1 };
+        std::atomic<double> maxSendRate { 500.0 };
+        std::array<std::atomic<float>, MetadataSender::maxSources> priorities;
+
+        juce::CriticalSection connectionLock;
+        juce::String pendingHostName;
+        int pendingPortNumber = 0;
+        bool connectionPending = false;
+        juce::String sharedMemoryName;      // of the ring the sender thread has, or is about to get
+        std::unique_ptr<SharedMetadataRing::Writer> pendingSharedMemory;
+        bool pendingSharedMemoryUdp = true;
+        bool sharedMemoryPending = false;
+        bool replaceSharedMemory = false;   // false: same ring, only the UDP flag changes
+        juce::File pendingRecordingFile;   // empty: stop
+        bool recordingPending = false;
+
+        /* load queries: flagged by the receiver thread, answered by the sender thread, to the
+           host / port given in the query, or to the metadata target when none was given */
+        std::atomic<const LoadMeter*> loadMeter { nullptr };
+        std::atomic<PositionInput*> positionInput { nullptr };
+        std::atomic<int> requestedListenPort { 0 };
+        std::atomic<bool> loadQueryPending { false };
+        juce::String replyHostName;
+        int replyPortNumber = 0;
+
+        /* only touched by the sender thread */
+        MetadataSender metadataSender;
+        MetadataLogWriter recorder;
+        SendScheduler<MetadataSender::maxSources> scheduler;
+        std::array<SourceMetadata, MetadataSender::maxSources> snapshots;
+        juce::OSCReceiver controlReceiver;
+        juce::OSCSender replySender;
+        juce::String connectedReplyHostName;
+        int connectedReplyPortNumber = 0;
+        int listenPort = 0;
+};
@@ -0,0 +1,631 @@
+/*
+  ==============================================================================
+    MultiSourceProcessor.cpp
+    Author:  regnier
+    Multi source version of the distance cues and OSC sender:
+    --> channel n of the bus is IOSONO source FIRST + n
+    --> level attenuation, air absorption, doppler effect for all sources in one instance
+
+  ==============================================================================
+*/
+
+#include "MultiSourceProcessor.h"
+
+
+//==============================================================================
+IOSONOMultiSourceAudioProcessor::IOSONOMultiSourceAudioProcessor()
+     : AudioProcessor (BusesProperties()
+                       .withInput  ("Input",  juce::AudioChannelSet::discreteChannels (maxSources), true)
+                       .withOutput ("Output", juce::AudioChannelSet::discreteChannels (maxSources), true)
+                       ), apvts(*this, nullptr, "Parameters", createParameters())
+{
+    for (int s = 0; s < maxSources; ++s)
+    {
+        azimParams[(size_t)s] = apvts.getRawParameterValue("AZIM" + juce::String(s + 1));
+        elevParams[(size_t)s] = apvts.getRawParameterValue("ELEV" + juce::String(s + 1));
+        distParams[(size_t)s] = apvts.getRawParameterValue("DIST" + juce::String(s + 1));
+    }
+
+    airParam = apvts.getRawParameterValue("AIR");
+    dopplerParam = apvts.getRawParameterValue("DOPPLER");
+    radiusParam = apvts.getRawParameterValue("RADIUS");
+    factorParam = apvts.getRawParameterValue("FACTOR");
+    firstParam = apvts.getRawParameterValue("FIRST");
+    typeParam = apvts.getRawParameterValue("TYPE");
+    timeTagParam = apvts.getRawParameterValue("TIMETAG");
+    outputLatencyParam = apvts.getRawParameterValue("OUTLATENCY");
+
+    // establish OSC connection, then start the sender thread (up to 500 Hz per source)
+    metadataSender.connect("127.0.0.1", 9001);
+    metadataSender.setNumSlots(0);
+    metadataSender.setMaxSendRate(500.0);
+    metadataSender.start();
+
+    // the latency is only recomputed when these change, the shared memory ring is named after FIRST
+    apvts.addParameterListener("DOPPLER", this);
+    apvts.addParameterListener("LATCOMP", this);
+    apvts.addParameterListener("LATREF", this);
+    apvts.addParameterListener("FIRST", this);
+    apvts.addParameterListener("PRIORITY", this);
+
+    for (int s = 0; s < maxSources; ++s)
+        metadataSender.setPriority(s, apvts.getRawParameterValue("PRIORITY")->load());
+}
+
+
+IOSONOMultiSourceAudioProcessor::~IOSONOMultiSourceAudioProcessor()
+{
+    cancelPendingUpdate();
+    metadataSender.stop();
+}
+
+//==============================================================================
+const juce::String IOSONOMultiSourceAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool IOSONOMultiSourceAudioProcessor::acceptsMidi() const
+{
+    return false;
+}
+
+bool IOSONOMultiSourceAudioProcessor::producesMidi() const
+{
+    return false;
+}
+
+bool IOSONOMultiSourceAudioProcessor::isMidiEffect() const
+{
+    return false;
+}
+
+double IOSONOMultiSourceAudioProcessor::getTailLengthSeconds() const
+{
+    // with DOPPLER, the input keeps coming out for as long as the line is
+    if (apvts.getRawParameterValue("DOPPLER")->load() > 0.5f)
+        return (double)DistanceCues::kMaxDistance * DistanceCues::kSecondsPerMeter;
+
+    return 0.0;
+}
+
+int IOSONOMultiSourceAudioProcessor::getNumPrograms()
+{
+    return 1;
+}
+
+int IOSONOMultiSourceAudioProcessor::getCurrentProgram()
+{
+    return 0;
+}
+
+void IOSONOMultiSourceAudioProcessor::setCurrentProgram (int index)
+{
+}
+
+const juce::String IOSONOMultiSourceAudioProcessor::getProgramName (int index)
+{
+    return {};
+}
+
+void IOSONOMultiSourceAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+}
+
+//==============================================================================
+void IOSONOMultiSourceAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    const auto numSources = juce::jmin(maxSources, getTotalNumInputChannels());
+
+    // delay lines sized for the maximum distance at this sample rate, one per source in use
+    maxDelaySamples = std::ceil(DistanceCues::kMaxDistance * DistanceCues::kSecondsPerMeter * (float)sampleRate);
+
+    numDelayLines = juce::jmax(1, numSources);
+
+    for (int s = 0; s < numDelayLines; ++s)
+        dopplerDelays[(size_t)s].prepare({ sampleRate, static_cast<juce::uint32> (samplesPerBlock), 1 }, (int)maxDelaySamples, dopplerCompactStorage.load());
+
+    crossfadeSamples = juce::jmax(1, (int)(0.01 * sampleRate)); // 10 ms
+    crossfadeRemaining = 0;
+
+    audioClock.reset(sampleRate);
+    blockTimeMs = 0.0;
+    transportSeconds = -1.0;
+    transportPlaying = false;
+    followingPlayback.fill(false);
+
+    // latency compensated doppler, reported before the first block
+    reportedCompensation.store(getCompensationSamples(sampleRate));
+    delayCompensation = (float)reportedCompensation.load();
+    setLatencySamples(reportedCompensation.load());
+
+    scratchBlockSize = juce::jmax(1, samplesPerBlock);
+    interleaved.assign((size_t)(scratchBlockSize * maxSources / laneWidth), Register::expand(0.0f));
+    delayRamp.assign((size_t)scratchBlockSize, 0.0f);
+    delayedScratch.assign((size_t)scratchBlockSize, 0.0f);
+
+    // start every source at its target, no ramp on the first block
+    const auto radius = apvts.getRawParameterValue("RADIUS")->load();
+    const auto factor = apvts.getRawParameterValue("FACTOR")->load();
+
+    for (int s = 0; s < maxSources; ++s)
+    {
+        const auto distance = juce::jlimit(DistanceCues::kMinDistance, DistanceCues::kMaxDistance, distParams[(size_t)s]->load());
+        const auto cutoff = juce::jlimit(20.0, 0.499 * sampleRate, (double)air.cutoffFor(distance));
+
+        sources.distance[s] = distance;
+        sources.gain[s] = DistanceCues::gainForDistance(distance, radius, factor);
+        sources.coefficient[s] = AbsorptionFilter::coefficientFor((float)cutoff, sampleRate);
+        sources.delay[s] = DistanceCues::delayForDistance(distance, sampleRate, maxDelaySamples, delayCompensation);
+        sources.gainStep[s] = sources.coefficientStep[s] = sources.delayStep[s] = 0.0f;
+        sources.filterState[s] = 0.0f;
+    }
+
+    dopplerWasOn = apvts.getRawParameterValue("DOPPLER")->load() > 0.5f;
+
+    publishMetadata(numSources);
+}
+
+void IOSONOMultiSourceAudioProcessor::releaseResources()
+{
+}
+
+bool IOSONOMultiSourceAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    // one channel per source, same number of channels in and out
+    const auto numChannels = layouts.getMainOutputChannels();
+
+    if (numChannels < 1 || numChannels > maxSources)
+        return false;
+
+    return layouts.getMainOutputChannelSet() == layouts.getMainInputChannelSet();
+}
+
+void IOSONOMultiSourceAudioProcessor::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+
+    if (isNonRealtime)
+        metadataSender.stop();
+    else
+        metadataSender.start();
+}
+
+void IOSONOMultiSourceAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ScopedNoDenormals noDenormals;
+    blockTimeMs = audioClock.blockStart(buffer.getNumSamples());
+
+    const auto numSources = juce::jmin(maxSources, getTotalNumInputChannels(), buffer.getNumChannels());
+    const auto numSamples = buffer.getNumSamples();
+
+    if (numSources == 0 || numSamples == 0)
+        return;
+
+    auto  absorb        = airParam->load() > 0.5f;
+    auto  dopplerEffect = dopplerParam->load() > 0.5f;
+
+    transportSeconds = MetadataLog::getTransportSeconds(getPlayHead(), getSampleRate(), transportPlaying);
+    updateLatency();
+    updatePlayback(numSources);
+    updateTargets(numSources, numSamples);
+
+    // doppler: per source delay line, channel by channel. a toggle crossfades from the previous state,
+    // one during a fade waits for it to finish (10 ms): restarting would jump back to fully wet or dry
+    if (dopplerEffect != dopplerWasOn && crossfadeRemaining == 0)
+    {
+        crossfadeRemaining = crossfadeSamples;
+        dopplerWasOn = dopplerEffect;
+    }
+
+    processDelay(buffer, numSources, dopplerWasOn);
+
+    // absorption + gain: all sources at once, sample by sample
+    if (absorb)
+        processFilterAndGain<true>(buffer, numSources);
+    else
+        processFilterAndGain<false>(buffer, numSources);
+
+    publishMetadata(numSources);
+}
+
+bool IOSONOMultiSourceAudioProcessor::loadPlayback (const juce::File& file)
+{
+    auto player = std::make_unique<MetadataLogPlayer>();
+
+    if (! player->open(file))
+        return false;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(playbackLock);
+        std::swap(playback, player);
+    }
+
+    // the previous player (and its prefetch thread) is deleted here, outside the lock
+    return true;
+}
+
+void IOSONOMultiSourceAudioProcessor::clearPlayback()
+{
+    std::unique_ptr<MetadataLogPlayer> player;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(playbackLock);
+        std::swap(playback, player);
+    }
+}
+
+void IOSONOMultiSourceAudioProcessor::updatePlayback (int numSources)
+{
+    const juce::SpinLock::ScopedTryLockType lock(playbackLock);
+
+    // being replaced right now: hold the last positions for this block
+    if (! lock.isLocked())
+        return;
+
+    if (playback == nullptr || transportSeconds < 0.0)
+    {
+        followingPlayback.fill(false);
+        return;
+    }
+
+    // follows the transport whether it plays or not, so that a locate shows the recorded positions
+    playback->advanceTo(transportSeconds);
+
+    const auto first = (int)firstParam->load();
+
+    for (int s = 0; s < numSources; ++s)
+        followingPlayback[(size_t)s] = playback->getSource(first + s, playbackSources[(size_t)s]);
+}
+
+void IOSONOMultiSourceAudioProcessor::updateTargets (int numSources, int numSamples)
+{
+    const auto sampleRate = getSampleRate();
+    const auto radius = radiusParam->load();
+    const auto factor = factorParam->load();
+
+    // fraction of the remaining distance to the target covered by this block
+    const auto invNumSamples = 1.0f / (float)numSamples;
+    const auto gainAmount   = (float)juce::jmin(1.0, numSamples / (gainRampSeconds * sampleRate)) * invNumSamples;
+    const auto cutoffAmount = (float)juce::jmin(1.0, numSamples / (cutoffRampSeconds * sampleRate)) * invNumSamples;
+    const auto delayAmount  = (float)juce::jmin(1.0, numSamples / (delayRampSeconds * sampleRate)) * invNumSamples;
+
+    for (int s = 0; s < numSources; ++s)
+        sources.distance[s] = juce::jlimit(DistanceCues::kMinDistance, DistanceCues::kMaxDistance,
+                                           followingPlayback[(size_t)s] ? playbackSources[(size_t)s].distance : distParams[(size_t)s]->load());
+
+    for (int s = 0; s < numSources; ++s)
+    {
+        const auto distance = sources.distance[s];
+
+        const auto gainTarget = DistanceCues::gainForDistance(distance, radius, factor);
+        const auto cutoff = juce::jlimit(20.0, 0.499 * sampleRate, (double)air.cutoffFor(distance));
+        const auto coefficientTarget = AbsorptionFilter::coefficientFor((float)cutoff, sampleRate);
+        const auto delayTarget = DistanceCues::delayForDistance(distance, sampleRate, maxDelaySamples, delayCompensation);
+
+        sources.gainStep[s]        = (gainTarget - sources.gain[s]) * gainAmount;
+        sources.coefficientStep[s] = (coefficientTarget - sources.coefficient[s]) * cutoffAmount;
+        sources.delayStep[s]       = (delayTarget - sources.delay[s]) * delayAmount;
+    }
+}
+
+int IOSONOMultiSourceAudioProcessor::getCompensationSamples (double sampleRate) const
+{
+    // nothing to compensate without the delay lines
+    if (apvts.getRawParameterValue("DOPPLER")->load() < 0.5f || apvts.getRawParameterValue("LATCOMP")->load() < 0.5f)
+        return 0;
+
+    return juce::jmin(DistanceCues::latencyForReference(apvts.getRawParameterValue("LATREF")->load(), sampleRate), (int)maxDelaySamples);
+}
+
+void IOSONOMultiSourceAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
+{
+    // any thread: the latency is recomputed and reported on the message thread, the ring renamed there too
+    // lock-free, read by the sender thread at its next round
+    if (parameterID == "PRIORITY")
+    {
+        for (int s = 0; s < maxSources; ++s)
+            metadataSender.setPriority(s, newValue);
+
+        return;
+    }
+
+    if (parameterID == "FIRST")
+    {
+        if (! sharedMemoryEnabled.load())
+            return;
+
+        transportChanged.store(true);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void IOSONOMultiSourceAudioProcessor::handleAsyncUpdate()
+{
+    const auto compensation = getCompensationSamples(getSampleRate());
+    reportedCompensation.store(compensation);
+    setLatencySamples(compensation);
+
+    if (transportChanged.exchange(false))
+        applyTransport((int)apvts.getRawParameterValue("FIRST")->load());
+}
+
+bool IOSONOMultiSourceAudioProcessor::setSharedMemoryTransport (bool shouldUseSharedMemory, bool alsoSendUdp)
+{
+    sharedMemoryEnabled.store(shouldUseSharedMemory);
+    sharedMemoryUdp.store(alsoSendUdp);
+    return applyTransport((int)apvts.getRawParameterValue("FIRST")->load());
+}
+
+bool IOSONOMultiSourceAudioProcessor::applyTransport (int first)
+{
+    // one ring per instance, named after its first source: instances covering different sources never share a writer
+    if (! sharedMemoryEnabled.load())
+    {
+        sharedMemoryOpen.store(false);
+        return metadataSender.useSharedMemory({}, true);
+    }
+
+    const auto opened = metadataSender.useSharedMemory("iosono-metadata-multi-" + juce::String(first), sharedMemoryUdp.load());
+    sharedMemoryOpen.store(opened);
+    return opened;
+}
+
+void IOSONOMultiSourceAudioProcessor::updateLatency()
+{
+    const auto compensation = (float)reportedCompensation.load();
+
+    if (compensation == delayCompensation)
+        return;
+
+    // the host moves the track by the latency difference at once: the lines jump with it rather than gliding (no pitch sweep)
+    for (int s = 0; s < maxSources; ++s)
+        sources.delay[s] = juce::jlimit(1.0f, maxDelaySamples, sources.delay[s] + delayCompensation - compensation);
+
+    delayCompensation = compensation;
+}
+
+void IOSONOMultiSourceAudioProcessor::processDelay (juce::AudioBuffer<float>& buffer, int numSources, bool dopplerEffect)
+{
+    const auto numSamples = buffer.getNumSamples();
+    const auto step = 1.0f / (float)crossfadeSamples;
+    auto* delayed = delayedScratch.data();
+
+    // in chunks of the scratch size, in case the host sends more than it announced
+    for (int chunkStart = 0; chunkStart < numSamples; chunkStart += scratchBlockSize)
+    {
+        const auto chunkLength = juce::jmin(scratchBlockSize, numSamples - chunkStart);
+        const auto fading = crossfadeRemaining > 0;
+        const auto start = (float)(crossfadeSamples - crossfadeRemaining) * step;
+
+        // sources added without a prepareToPlay have no line: they stay dry
+        for (int s = 0; s < juce::jmin(numSources, numDelayLines); ++s)
+        {
+            auto* samples = buffer.getWritePointer(s, chunkStart);
+            auto& line = dopplerDelays[(size_t)s];
+
+            // the delay ramp, the same whether the line is read or not
+            const auto delay = sources.delay[s];
+            const auto delayStep = sources.delayStep[s];
+            for (int sample = 0; sample < chunkLength; ++sample)
+                delayRamp[(size_t)sample] = delay + delayStep * (float)(sample + 1);
+
+            sources.delay[s] = delay + delayStep * (float)chunkLength;
+
+            if (! dopplerEffect && ! fading)
+            {
+                // bypassed: only keep the line up to date
+                line.push(&samples, chunkLength);
+                continue;
+            }
+
+            if (! fading)
+            {
+                line.process(&samples, &samples, chunkLength, delayRamp.data());
+                continue;
+            }
+
+            line.process(&samples, &delayed, chunkLength, delayRamp.data());
+
+            // dry to delayed when DOPPLER was switched on, delayed to dry when switched off
+            for (int sample = 0; sample < chunkLength; ++sample)
+            {
+                const auto fadeIn = juce::jmin(1.0f, start + (float)(sample + 1) * step);
+                const auto wet = dopplerEffect ? fadeIn : 1.0f - fadeIn;
+                samples[sample] += wet * (delayed[sample] - samples[sample]);
+            }
+        }
+
+        crossfadeRemaining = juce::jmax(0, crossfadeRemaining - chunkLength);
+    }
+}
+
+template <bool absorb>
+void IOSONOMultiSourceAudioProcessor::processFilterAndGain (juce::AudioBuffer<float>& buffer, int numSources)
+{
+    static_assert(maxSources % laneWidth == 0, "the source bank must be made of whole registers");
+
+    const auto numSamples = buffer.getNumSamples();
+    const auto numGroups = numSources / laneWidth;                      // whole registers of sources
+    const auto stride = (numSources + laneWidth - 1) / laneWidth;       // registers per frame
+
+    auto* gain            = sources.gain;
+    auto* gainStep        = sources.gainStep;
+    auto* coefficient     = sources.coefficient;
+    auto* coefficientStep = sources.coefficientStep;
+    auto* state           = sources.filterState;
+
+    // same memory seen as floats: frame n, source s at [n * stride * laneWidth + s]
+    auto* frames = interleaved.data();
+    auto* samples = reinterpret_cast<float*>(frames);
+
+    for (int start = 0; start < numSamples; start += scratchBlockSize)
+    {
+        const auto numFrames = juce::jmin(scratchBlockSize, numSamples - start);
+
+        // channel-major -> sample-major, so that a register holds laneWidth sources
+        for (int s = 0; s < numSources; ++s)
+        {
+            const auto* in = buffer.getReadPointer(s, start);
+            for (int frame = 0; frame < numFrames; ++frame)
+                samples[frame * stride * laneWidth + s] = in[frame];
+        }
+
+        // a group of sources at a time, its ramps and filter state kept in registers over all the frames
+        for (int group = 0; group < numGroups; ++group)
+        {
+            const auto first = group * laneWidth;
+            auto gainLanes = Register::fromRawArray(gain + first);
+            auto coefficientLanes = Register::fromRawArray(coefficient + first);
+            auto stateLanes = Register::fromRawArray(state + first);
+            const auto gainStepLanes = Register::fromRawArray(gainStep + first);
+            const auto coefficientStepLanes = Register::fromRawArray(coefficientStep + first);
+
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                auto& x = frames[frame * stride + group];
+                gainLanes += gainStepLanes;
+                auto y = x;
+
+                if constexpr (absorb)
+                {
+                    coefficientLanes += coefficientStepLanes;
+                    y = AbsorptionFilter::processLanes(y, coefficientLanes, stateLanes);
+                }
+
+                x = gainLanes * y;
+            }
+
+            gainLanes.copyToRawArray(gain + first);
+            coefficientLanes.copyToRawArray(coefficient + first);
+            stateLanes.copyToRawArray(state + first);
+        }
+
+        // the sources left over, one at a time
+        for (int s = numGroups * laneWidth; s < numSources; ++s)
+        {
+            for (int frame = 0; frame < numFrames; ++frame)
+            {
+                auto& x = samples[frame * stride * laneWidth + s];
+                gain[s] += gainStep[s];
+                auto y = x;
+
+                if constexpr (absorb)
+                {
+                    coefficient[s] += coefficientStep[s];
+                    const auto v = coefficient[s] * (y - state[s]);
+                    y = v + state[s];
+                    state[s] = y + v;
+                }
+
+                x = gain[s] * y;
+            }
+        }
+
+        for (int s = 0; s < numSources; ++s)
+        {
+            auto* out = buffer.getWritePointer(s, start);
+            for (int frame = 0; frame < numFrames; ++frame)
+                out[frame] = samples[frame * stride * laneWidth + s];
+        }
+    }
+
+    // keep the coefficient moving while bypassed, so that enabling AIR does not jump
+    if constexpr (! absorb)
+        for (int s = 0; s < numSources; ++s)
+            coefficient[s] += coefficientStep[s] * (float)numSamples;
+}
+
+//==============================================================================
+bool IOSONOMultiSourceAudioProcessor::hasEditor() const
+{
+    return true;
+}
+
+juce::AudioProcessorEditor* IOSONOMultiSourceAudioProcessor::createEditor()
+{
+    // 64 x 3 parameters, a generic editor is good enough here
+    return new juce::GenericAudioProcessorEditor (*this);
+}
+
+//==============================================================================
+void IOSONOMultiSourceAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    auto state = apvts.copyState();
+    std::unique_ptr<juce::XmlElement> xml(state.createXml());
+    copyXmlToBinary(*xml, destData);
+}
+
+void IOSONOMultiSourceAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+
+    if (xmlState.get() != nullptr)
+        if (xmlState->hasTagName(apvts.state.getType()))
+            apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+}
+
+
+juce::AudioProcessorValueTreeState::ParameterLayout IOSONOMultiSourceAudioProcessor::createParameters()
+{
+    std::vector<std::unique_ptr<juce::RangedAudioParameter>> params;
+
+    for (int s = 1; s <= maxSources; ++s)
+    {
+        const auto n = juce::String(s);
+        params.push_back(std::make_unique<juce::AudioParameterFloat>    ("AZIM" + n, "azim " + n, 0.0f, 360.0f, 0.0f));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>    ("ELEV" + n, "elev " + n, -90.0f, 90.0f, 0.0f));
+        params.push_back(std::make_unique<juce::AudioParameterFloat>    ("DIST" + n, "dist " + n, juce::NormalisableRange<float>(0.0f, 300.0f, 0.01f, 0.5f), 1.0f));
+    }
+
+    params.push_back(std::make_unique<juce::AudioParameterInt>      ("TYPE", "type", 1, 2, 1));
+    params.push_back(std::make_unique<juce::AudioParameterInt>      ("FIRST", "first index", 1, 64, 1));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("RADIUS", "radius", 1.0f, 10.0f, 1.0f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("FACTOR", "factor", 0.0f, 10.0f, 1.0f));
+    params.push_back(std::make_unique<juce::AudioParameterInt>      ("AIR", "air", 0, 1, 0));
+    params.push_back(std::make_unique<juce::AudioParameterInt>      ("DOPPLER", "doppler", 0, 1, 0));
+    params.push_back(std::make_unique<juce::AudioParameterInt>      ("LATCOMP", "doppler latency compensation", 0, 1, 0));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("LATREF", "latency reference distance", juce::NormalisableRange<float>(0.0f, 300.0f, 0.01f, 0.5f), 1.0f)); // m, e.g. the closest source of the session
+    params.push_back(std::make_unique<juce::AudioParameterInt>      ("TIMETAG", "osc time tags", 0, 1, 0));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("OUTLATENCY", "output latency", 0.0f, 1000.0f, 0.0f)); // ms, host + device
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("PRIORITY", "send priority", 0.0f, 10.0f, 1.0f)); // all the sources of the instance
+
+    return { params.begin(), params.end() };
+}
+
+
+void IOSONOMultiSourceAudioProcessor::publishMetadata (int numSources)
+{
+    const auto type  = (int)typeParam->load();
+    const auto first = (int)firstParam->load();
+
+    // time tag: when the audio of this block is heard, i.e. after the output latency (+ each source's doppler delay)
+    const auto timeTags = timeTagParam->load() > 0.5f && blockTimeMs > 0.0;
+    const auto heardMs  = blockTimeMs + outputLatencyParam->load();
+    const auto delayMsPerSample = dopplerWasOn ? 1000.0 / getSampleRate() : 0.0;
+
+    // sources past index 64 are not sent
+    numSources = juce::jmin(numSources, maxSources - first + 1);
+
+    for (int s = 0; s < numSources; ++s)
+    {
+        // the log holds the azimuth as it was sent: IOSONO convention already
+        const auto* recorded = followingPlayback[(size_t)s] ? &playbackSources[(size_t)s] : nullptr;
+
+        SourceMetadata source;
+        source.index     = first + s;
+        source.type      = type - 1;
+        source.azimuth   = recorded != nullptr ? recorded->azimuth : DistanceCues::toIosonoAzimuth(azimParams[(size_t)s]->load());
+        source.elevation = recorded != nullptr ? recorded->elevation : elevParams[(size_t)s]->load();
+        source.distance  = recorded != nullptr ? recorded->distance : distParams[(size_t)s]->load();
+        source.volume    = sources.gain[s];
+        source.timeMs    = timeTags ? heardMs + sources.delay[s] * delayMsPerSample : 0.0;
+        source.transportSeconds = transportPlaying ? transportSeconds : -1.0;
+
+        // lock-free, picked up by the sender thread
+        metadataSender.publish(s, source);
+    }
+
+    metadataSender.setNumSlots(numSources);
+}
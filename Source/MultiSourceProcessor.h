@@ -0,0 +1,201 @@
+/*
+  ==============================================================================
+
+    MultiSourceProcessor.h
+    Created: 17 Oct 2026 2:55:32pm
+    @Author:  regnier
+    @Brief: Multi source variant of IOSONOSourceControlAudioProcessor. One instance takes a wide bus,
+    one channel per IOSONO source (up to 64), and applies the distance cues to all of them.
+    Per source state is kept in structure-of-arrays form so that the gain / absorption stage runs
+    across sources in a single vectorisable loop.
+    IOSONO_MULTI_SOURCE=1 (the IOSONOMultiSource target of CMakeLists.txt) makes createPluginFilter() return this processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AirAbsorption.h"
+#include "AbsorptionFilter.h"
+#include "DistanceCues.h"
+#include "MetadataSenderThread.h"
+#include "AudioClock.h"
+#include "DopplerDelay.h"
+#include "MetadataLog.h"
+
+#ifndef IOSONO_MULTI_SOURCE
+ #define IOSONO_MULTI_SOURCE 0
+#endif
+
+//==============================================================================
+/**
+*/
+class IOSONOMultiSourceAudioProcessor  : public juce::AudioProcessor,
+    private juce::AudioProcessorValueTreeState::Listener,
+    private juce::AsyncUpdater
+{
+public:
+    static constexpr int maxSources = 64;
+
+    //==============================================================================
+    IOSONOMultiSourceAudioProcessor();
+    ~IOSONOMultiSourceAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+
+    /* offline renders run faster than real time: the OSC thread is stopped meanwhile */
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    juce::AudioProcessorValueTreeState apvts;
+
+    /* metadata of all the sources written to the shared memory ring "iosono-metadata-multi-<FIRST>" (SharedMetadataRing.h),
+       with or without the UDP messages. message thread (the ring is created here).
+       false if the ring cannot be created, e.g. another running instance writes it: the metadata stays on UDP */
+    bool setSharedMemoryTransport(bool shouldUseSharedMemory, bool alsoSendUdp = false);
+
+    /* false when the shared memory transport is on but has no ring, e.g. after FIRST moved to a ring in use. any thread */
+    bool isSharedMemoryOpen() const noexcept { return sharedMemoryOpen.load(); }
+
+    /* records the metadata of all the sources as sent, stamped with the host transport time, while the transport plays
+       (MetadataLog.h). any thread */
+    void startRecording(const juce::File& file) { metadataSender.startRecording(file); }
+    void stopRecording() { metadataSender.stopRecording(); }
+
+    /* delay lines in 16 bit, half the memory of 64 sources at high sample rates. applied at the next prepareToPlay */
+    void setDopplerCompactStorage(bool shouldUseCompactStorage) { dopplerCompactStorage.store(shouldUseCompactStorage); }
+
+    /* each source recorded in this log (by index, FIRST + channel) follows it in sync with the host transport,
+       instead of its AZIM / ELEV / DIST. false if the file is not a log. message thread */
+    bool loadPlayback(const juce::File& file);
+    void clearPlayback();
+
+private:
+    AirAbsorption air;
+
+    juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
+
+    void publishMetadata (int numSources);
+    bool applyTransport (int first);
+
+    void updatePlayback (int numSources);
+    void updateTargets (int numSources, int numSamples);
+    int getCompensationSamples (double sampleRate) const;
+    void updateLatency();
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    void processDelay (juce::AudioBuffer<float>& buffer, int numSources, bool dopplerEffect);
+    template <bool absorb>
+    void processFilterAndGain (juce::AudioBuffer<float>& buffer, int numSources);
+
+    /* per source state, structure of arrays. Index = channel = source offset from FIRST */
+    struct SourceBank
+    {
+        alignas(32) float distance[maxSources];
+        alignas(32) float gain[maxSources];             // current value, ramped per sample
+        alignas(32) float gainStep[maxSources];
+        alignas(32) float coefficient[maxSources];      // absorption filter TPT coefficient
+        alignas(32) float coefficientStep[maxSources];
+        alignas(32) float filterState[maxSources];
+        alignas(32) float delay[maxSources];            // in samples
+        alignas(32) float delayStep[maxSources];
+    };
+
+    SourceBank sources;
+
+    /* cached raw parameter pointers, read once per block */
+    std::array<std::atomic<float>*, maxSources> azimParams;
+    std::array<std::atomic<float>*, maxSources> elevParams;
+    std::array<std::atomic<float>*, maxSources> distParams;
+    std::atomic<float>* airParam = nullptr;
+    std::atomic<float>* dopplerParam = nullptr;
+    std::atomic<float>* radiusParam = nullptr;
+    std::atomic<float>* factorParam = nullptr;
+    std::atomic<float>* firstParam = nullptr;
+    std::atomic<float>* typeParam = nullptr;
+    std::atomic<float>* timeTagParam = nullptr;
+    std::atomic<float>* outputLatencyParam = nullptr;
+
+    /* interleaved (sample-major) scratch for the filter / gain stage, frames padded to whole SIMD registers:
+       sources [g * laneWidth, g * laneWidth + laneWidth) of a frame are one register, filtered and scaled at once */
+    using Register = AbsorptionFilter::Register;
+    static constexpr int laneWidth = AbsorptionFilter::laneWidth;
+    std::vector<Register> interleaved;
+    int scratchBlockSize = 0;
+
+    /* one line per source (each has its own delay ramp), sized for the maximum distance at the current sample rate.
+       always fed, so that DOPPLER can be switched on without a gap: the switch crossfades between the dry and delayed signals */
+    std::array<DopplerDelay<DopplerInterpolation::Selected>, maxSources> dopplerDelays;   // IOSONO_DOPPLER_INTERPOLATION
+    int numDelayLines = 0;              // prepared, from the first
+    std::atomic<bool> dopplerCompactStorage { false };
+    std::vector<float> delayRamp;       // of the source being processed, one value per sample of the block
+    std::vector<float> delayedScratch;  // delayed signal while crossfading
+    float maxDelaySamples = 1.0f;
+    bool dopplerWasOn = false;
+    int crossfadeSamples = 1;
+    int crossfadeRemaining = 0;
+
+    /* latency compensated doppler (LATCOMP): the delay of LATREF meters is taken out of the lines and reported to the host.
+       recomputed and reported on the message thread when DOPPLER, LATCOMP or LATREF change, the audio thread moves the lines */
+    std::atomic<int> reportedCompensation { 0 };   // samples, as reported to the host
+    float delayCompensation = 0.0f;                 // samples, taken out of the lines, audio thread
+
+    /* ramp lengths, same as the single source smoothers */
+    static constexpr double gainRampSeconds = 0.02;
+    static constexpr double cutoffRampSeconds = 0.02;
+    static constexpr double delayRampSeconds = 0.15;
+
+    /* log playback, swapped under the lock. the audio thread only try-locks it, and keeps the last positions
+       for the block in the unlikely case it is being replaced */
+    juce::SpinLock playbackLock;
+    std::unique_ptr<MetadataLogPlayer> playback;
+    std::array<SourceMetadata, maxSources> playbackSources;
+    std::array<bool, maxSources> followingPlayback {};
+
+    /* host transport of the current block, -1 when the host gives none */
+    double transportSeconds = -1.0;
+    bool transportPlaying = false;
+
+    /* OSC message sender, runs on its own thread */
+    MetadataSenderThread metadataSender;
+    std::atomic<bool> sharedMemoryEnabled { false };
+    std::atomic<bool> sharedMemoryUdp { false };
+    std::atomic<bool> sharedMemoryOpen { false };
+    std::atomic<bool> transportChanged { false };  // FIRST changed: the ring is renamed on the message thread
+
+    /* time of the current block, for the OSC time tags */
+    AudioClock audioClock;
+    double blockTimeMs = 0.0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IOSONOMultiSourceAudioProcessor)
+};
@@ -12,10 +12,11 @@
 
 //==============================================================================
 IOSONOSourceControlAudioProcessorEditor::IOSONOSourceControlAudioProcessorEditor (IOSONOSourceControlAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p),
+      radar([&p](SourceMetadata* sources, int) { return p.getDisplayMetadata(sources[0]) ? 1 : 0; })
 {
     
-    setSize(300, 320);
+    setSize(300, 495);
     setWantsKeyboardFocus(true);
 
 
@@ -124,6 +125,11 @@ IOSONOSourceControlAudioProcessorEditor::IOSONOSourceControlAudioProcessorEditor
     dopplerBtn.setClickingTogglesState(true);
     
     // airBtn.onClick = [this] { airBtnClicked(); };
+
+    loadLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+    loadLabel.setFont(12.0f);
+    loadLabel.setJustificationType(juce::Justification::centred);
+    loadLabel.setText("DSP load: measuring...", juce::dontSendNotification);
     
 
     // add UI elements to the editor
@@ -141,6 +147,8 @@ IOSONOSourceControlAudioProcessorEditor::IOSONOSourceControlAudioProcessorEditor
     addAndMakeVisible(&volFactorSlider);
     addAndMakeVisible(&airBtn);
     addAndMakeVisible(&dopplerBtn);
+    addAndMakeVisible(&loadLabel);
+    addAndMakeVisible(&radar);
 
     // create attachments
     azimSliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.apvts, "AZIM", azimSlider);
@@ -166,11 +174,14 @@ IOSONOSourceControlAudioProcessorEditor::IOSONOSourceControlAudioProcessorEditor
     airBtn.addListener(this);
     dopplerBtn.addListener(this);
 
+    // load meter refresh
+    startTimerHz(4);
             
 }
 
 IOSONOSourceControlAudioProcessorEditor::~IOSONOSourceControlAudioProcessorEditor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -182,6 +193,7 @@ void IOSONOSourceControlAudioProcessorEditor::paint (juce::Graphics& g)
 
     g.drawRoundedRectangle(10, 45, 280, 165, 4, 1);
     g.drawRoundedRectangle(10, 215, 280, 100, 4, 1);
+    g.drawRoundedRectangle(10, 345, 280, 145, 4, 1);
 
     g.setColour (juce::Colours::white);
     g.setFont (15.0f);
@@ -206,6 +218,10 @@ void IOSONOSourceControlAudioProcessorEditor::resized()
 
     airBtn.setBounds(40, 285, 100, 22);
     dopplerBtn.setBounds(160, 285, 100, 22);
+
+    loadLabel.setBounds(10, 320, 280, 20);
+
+    radar.setBounds(12, 347, 276, 141);
     
 }
 
@@ -214,6 +230,23 @@ void IOSONOSourceControlAudioProcessorEditor::buttonClicked(juce::Button* button
 
 }
 
+void IOSONOSourceControlAudioProcessorEditor::timerCallback()
+{
+    LoadMeter::Stats stats;
+
+    if (! audioProcessor.getLoadStats(stats))
+        return;
+
+    // percent of the block budget: mean [min-max], then mean per stage (smoothing / delay / filter)
+    auto percent = [](float load) { return juce::String(load * 100.0f, 1); };
+
+    loadLabel.setText("DSP " + percent(stats.meanLoad) + "% [" + percent(stats.minLoad) + "-" + percent(stats.maxLoad) + "]"
+                      + "  S/D/F " + percent(stats.stageLoad[LoadMeter::smoothing]) + "/" + percent(stats.stageLoad[LoadMeter::delay])
+                      + "/" + percent(stats.stageLoad[LoadMeter::filter])
+                      + "  over " + juce::String(stats.overruns) + "  xrun " + juce::String(stats.xruns),
+                      juce::dontSendNotification);
+}
+
 
 void IOSONOSourceControlAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
 {
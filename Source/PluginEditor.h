@@ -10,6 +10,7 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SourceRadar.h"
 
 //==============================================================================
 /**
@@ -18,8 +19,8 @@ class IOSONOSourceControlAudioProcessorEditor  : public juce::AudioProcessorEdit
     private juce::Slider::Listener,
     private juce::ComboBox::Listener,
     private juce::TextEditor::Listener,
-    private juce::Button::Listener
-    // private juce::Timer
+    private juce::Button::Listener,
+    private juce::Timer
 {
 public:
     IOSONOSourceControlAudioProcessorEditor (IOSONOSourceControlAudioProcessor&);
@@ -44,6 +45,7 @@ private:
     void comboBoxChanged(juce::ComboBox* ComboBox) override;
     void textEditorTextChanged(juce::TextEditor& textEditor) override;
     void buttonClicked(juce::Button* button) override;
+    void timerCallback() override;
 
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -75,6 +77,11 @@ private:
     juce::TextButton airBtn;
     juce::TextButton dopplerBtn;
 
+    juce::Label loadLabel;
+
+    /* position of the source, from the metadata published by the audio thread */
+    SourceRadar radar;
+
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> azimSliderAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> elevSliderAttachment;
@@ -11,6 +11,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "MultiSourceProcessor.h"
 
 
 //==============================================================================
@@ -30,22 +31,50 @@ IOSONOSourceControlAudioProcessor::IOSONOSourceControlAudioProcessor()
     
     
 
-    // start timer  t=20ms
-    startTimer(20);
-
-    // establish OSC connection
-    oscMessageSender.connect("127.0.0.1", 9001);
+    // establish OSC connection, then start the sender thread (up to 500 Hz per source)
+    oscConnect();
+    metadataSender.setNumSlots(1);
+    metadataSender.setMaxSendRate(500.0);
+    metadataSender.setLoadMeter(&loadMeter);
+    metadataSender.setPositionInput(&positionInput);
+    metadataSender.listen(controlPortBase + (int)apvts.getRawParameterValue("INDEX")->load());
+    metadataSender.start();
+
+    airParam = apvts.getRawParameterValue("AIR");
+    dopplerParam = apvts.getRawParameterValue("DOPPLER");
+    distParam = apvts.getRawParameterValue("DIST");
+    radiusParam = apvts.getRawParameterValue("RADIUS");
+    factorParam = apvts.getRawParameterValue("FACTOR");
+    latencyCompensationParam = apvts.getRawParameterValue("LATCOMP");
+    latencyReferenceParam = apvts.getRawParameterValue("LATREF");
+    indexParam = apvts.getRawParameterValue("INDEX");
+    typeParam = apvts.getRawParameterValue("TYPE");
+    azimuthParam = apvts.getRawParameterValue("AZIM");
+    elevationParam = apvts.getRawParameterValue("ELEV");
+    timeTagParam = apvts.getRawParameterValue("TIMETAG");
+    outputLatencyParam = apvts.getRawParameterValue("OUTLATENCY");
 
     // add listeners
-    apvts.addParameterListener("DIST", this); 
     apvts.addParameterListener("RADIUS", this);
     apvts.addParameterListener("FACTOR", this);
-
+    apvts.addParameterListener("HUMIDITY", this);
+    apvts.addParameterListener("TEMP", this);
+    apvts.addParameterListener("PRESSURE", this);
+    apvts.addParameterListener("INDEX", this);
+    apvts.addParameterListener("DOPPLER", this);
+    apvts.addParameterListener("LATCOMP", this);
+    apvts.addParameterListener("LATREF", this);
+    apvts.addParameterListener("PRIORITY", this);
+
+    metadataSender.setPriority(0, apvts.getRawParameterValue("PRIORITY")->load());
 }
 
 
 IOSONOSourceControlAudioProcessor::~IOSONOSourceControlAudioProcessor()
 {
+    cancelPendingUpdate();
+    metadataSender.stop();
+    tableBuilder.removeAllJobs(true, 2000);
 }
 
 //==============================================================================
@@ -83,6 +112,10 @@ bool IOSONOSourceControlAudioProcessor::isMidiEffect() const
 
 double IOSONOSourceControlAudioProcessor::getTailLengthSeconds() const
 {
+    // with DOPPLER, the input keeps coming out for as long as the line is (compensated or not, the line is the same)
+    if (dopplerParam != nullptr && dopplerParam->load() > 0.5f)
+        return (double)dopplerMaximumDistance.load() * DistanceCues::kSecondsPerMeter;
+
     return 0.0;
 }
 
@@ -113,31 +146,64 @@ void IOSONOSourceControlAudioProcessor::changeProgramName (int index, const juce
 //==============================================================================
 void IOSONOSourceControlAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32> (samplesPerBlock), 2 };
-
-    // filter init
-    lowpass.setType(juce::dsp::FirstOrderTPTFilterType::lowpass);
-    lowpass.prepare(spec);
-    lowpass.setCutoffFrequency(300.0f);
+    // as many channels as the layout has, the same delay and gain on all of them
+    numChannels = juce::jlimit(1, maxChannels, juce::jmin(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+    previousBank = numChannels;
+    juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32> (samplesPerBlock), static_cast<juce::uint32> (numChannels) };
+
+    // clock for the OSC time tags
+    audioClock.reset(sampleRate);
+    blockTimeMs = 0.0;
+
+    loadMeter.prepare(sampleRate, samplesPerBlock);
+    positionInput.reset();
+    followingPositionInput = false;
+    followingTrajectory = false;
+    followingPlayback = false;
+    trajectoryEndValid = false;
+    transportSeconds = -1.0;
+    transportPlaying = false;
+
+    // filter init, 2 banks of numChannels channels for the kernel crossfades
+    lowpass.prepare({ sampleRate, static_cast<juce::uint32> (samplesPerBlock), static_cast<juce::uint32> (2 * numChannels) });
 
     // delay init
-    LagrangeDelay.prepare(spec);
-    LagrangeDelay.reset();
+    // e.g. 300 m: 42k samples @48 kHz, 170k samples @192 kHz
+    maxDelaySamples = std::ceil(dopplerMaximumDistance.load() * DistanceCues::kSecondsPerMeter * (float)sampleRate);
+    dopplerDelay.prepare(spec, (int)maxDelaySamples, dopplerCompactStorage.load());
+    delayRamp.assign(maxSegmentSize, 0.0f);
+    gainRamp.assign(maxSegmentSize, 0.0f);
+    coefficientRamp.assign(maxSegmentSize, 0.0f);
+    dopplerBuffer.setSize(numChannels, maxSegmentSize);
+    crossfadeBuffer.setSize(numChannels, maxSegmentSize);
+    laneGroups = (numChannels + laneWidth - 1) / laneWidth;
+    laneFrames.assign((size_t)(maxSegmentSize * laneGroups), Register::expand(0.0f));
+
+    // kernels, no crossfade on the first block
+    currentMode = previousMode = (airParam->load() > 0.5f ? absorbFlag : 0) | (dopplerParam->load() > 0.5f ? dopplerFlag : 0);
+    crossfadeSamples = juce::jmax(1, (int)(0.01 * sampleRate)); // 10 ms
+    crossfadeRemaining = 0;
     
-    // smoothers init
-    smoothDelay.reset(getSampleRate(), 0.15);   // ramp length of 150 ms.. arbitrary.. 
-    smoothDelay.setCurrentAndTargetValue(1.0);
-
-    smoothAmp.reset(getSampleRate(), 0.02);     // ramp length of 20 ms.. arbitrary.. 
-    smoothAmp.setCurrentAndTargetValue(0.0);
+    // distance smoother init, starting at the parameter: no ramp on the first block
+    dist = juce::jlimit(DistanceCues::kMinDistance, DistanceCues::kMaxDistance, distParam->load());
+    smoothDistance.reset(sampleRate, (currentMode & dopplerFlag) != 0 ? dopplerRampSeconds : levelRampSeconds);
+    smoothDistance.setCurrentAndTargetValue(dist);
 
-    smoothCutoff.reset(getSampleRate(), 0.02);  // ramp length of 20 ms.. arbitrary.. 
-    smoothCutoff.setCurrentAndTargetValue(0.0);
+    // latency compensated doppler, reported before the first block
+    reportedCompensation.store(getCompensationSamples(sampleRate));
+    delayCompensation = (float)reportedCompensation.load();
+    setLatencySamples(reportedCompensation.load());
 
     // calculate inital values
-    calculateVolume();
+    cueLawsChanged.store(false);
+    recomputeCues = false;
+    segmentDistance = dist;
+    segmentGain = DistanceCues::gainForDistance(dist, radiusParam->load(), factorParam->load());
+    segmentDelay = DistanceCues::delayForDistance(dist, sampleRate, maxDelaySamples, delayCompensation);
+    lowpass.setCutoffFrequency((float)juce::jlimit(20.0, 0.499 * sampleRate, (double)air.cutoffFor(dist)));
     calculateAzimuth();
-    calculateDelay();
+
+    publishMetadata();
 }
 
 void IOSONOSourceControlAudioProcessor::releaseResources()
@@ -153,12 +219,11 @@ bool IOSONOSourceControlAudioProcessor::isBusesLayoutSupported (const BusesLayou
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // one source on any number of channels: mono is the cheapest, stereo stays the default
+    // (some hosts, such as certain GarageBand versions, will only load plugins that support stereo)
+    const auto numOutputChannels = layouts.getMainOutputChannels();
+
+    if (numOutputChannels < 1 || numOutputChannels > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -172,9 +237,24 @@ bool IOSONOSourceControlAudioProcessor::isBusesLayoutSupported (const BusesLayou
 }
 #endif
 
+void IOSONOSourceControlAudioProcessor::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+
+    // a bounce would stream the movements to the renderer at the render speed. the last snapshot is sent again on return
+    if (isNonRealtime)
+        metadataSender.stop();
+    else
+        metadataSender.start();
+}
+
 void IOSONOSourceControlAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    loadMeter.beginBlock(buffer.getNumSamples());
+    blockTimeMs = audioClock.blockStart(buffer.getNumSamples());
+    updateTransport();
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -188,60 +268,76 @@ void IOSONOSourceControlAudioProcessor::processBlock (juce::AudioBuffer<float>&
     //    buffer.clear (i, 0, buffer.getNumSamples());
 
 
-    // TODO: create callbacks for these 2 instead of polling at every block
-    auto  absorb        = apvts.getRawParameterValue("AIR")->load();
-    auto  dopplerEffect = apvts.getRawParameterValue("DOPPLER")->load();
+    // processing mode from the AIR / DOPPLER toggles, a change crossfades between kernels.
+    // a toggle during a fade waits for it to finish (10 ms): restarting would drop the half faded kernel at once
+    const auto mode = (airParam->load() > 0.5f ? absorbFlag : 0) | (dopplerParam->load() > 0.5f ? dopplerFlag : 0);
 
-    smoothAmp.setTargetValue(volume);
-    smoothCutoff.setTargetValue(cutoff);
-    smoothDelay.setTargetValue(delayValue);
+    if (mode != currentMode && crossfadeRemaining == 0)
+        startCrossfade(mode);
 
-    auto leftInSamples   = buffer.getReadPointer(0);
-    auto rightInSamples  = buffer.getReadPointer(1);
-    auto leftOutSamples  = buffer.getWritePointer(0);
-    auto rightOutSamples = buffer.getWritePointer(1);
-    float leftSample;
-    float rightSample;
+    updateLatency();
 
-    
-    // DBG("dist: " << dist << " freq: " << cutoff << " Delay: " << delayValue << " Volume: " << volume); // debug
-
-    for (int sample = 0; sample < buffer.getNumSamples(); sample++)
-    {
+    // target distance, once per block whatever the rate of parameter changes
+    updateDistanceCues(buffer.getNumSamples());
 
-        // double monoIn = (*(leftInSamples + sample) + *(rightInSamples + sample)) * 0.5; //  conversion to mono (for IOSONO, 1 source = 1 channel only)
-        leftSample = *(leftInSamples + sample);
-        rightSample = *(rightInSamples + sample);
-        
+    loadMeter.lap(LoadMeter::smoothing);
 
-        // get smoothed values
-        auto currentDelay = smoothDelay.getNextValue(); 
-        auto currentVolume = smoothAmp.getNextValue();
-        auto currentCutoff = smoothCutoff.getNextValue();
-
-        // enter delay line
-        LagrangeDelay.setDelay(currentDelay);           // set delay value
-        LagrangeDelay.pushSample(0, leftSample);        // delay line input L
-        LagrangeDelay.pushSample(1, rightSample);       // delay line input R
-
-        // set absorption frequency
-        lowpass.setCutoffFrequency(currentCutoff);
+    // layout changed without a prepareToPlay: nothing sensible to do with the extra channels
+    if (buffer.getNumChannels() < numChannels)
+    {
+        jassertfalse;
+        buffer.clear();
+        loadMeter.endBlock();
+        return;
+    }
 
-        /******************** Avoid branching ***********************/
+    // channel pointers of the current segment, numChannels of them
+    std::array<const float*, maxChannels> dry, delayed;
+    std::array<float*, maxChannels> out, fadingOut;
 
-        // if doppler, delay inputs
-        leftSample  = dopplerEffect * LagrangeDelay.popSample(0) + (1 - dopplerEffect) * leftSample;
-        rightSample = dopplerEffect * LagrangeDelay.popSample(1) + (1 - dopplerEffect) * rightSample;
 
-        
-        // if air absorption, filter and attenuate, else, only attenuate 
-        *(leftOutSamples + sample)  = currentVolume * (absorb * lowpass.processSample(0, leftSample)  + (1 - absorb) * leftSample);
-        *(rightOutSamples + sample) = currentVolume * (absorb * lowpass.processSample(1, rightSample) + (1 - absorb) * rightSample);
+    const int numSamples = buffer.getNumSamples();
+    const int controlInterval = cutoffUpdateInterval.load();
 
-        /**************** IOSONO Mode ****************/
-        /* when using the IOSONO renderer: gain attenuation using currentVolume should be removed, as it's already in the metadata  */      
-        // *(leftOutSamples + sample)  = absorb  * lowpass.processSample(0, leftSample)  + (1 - absorb) * leftSample;
-        // *(rightOutSamples + sample) = absorb  * lowpass.processSample(1, rightSample) + (1 - absorb) * rightSample;
+    for (int segmentStart = 0; segmentStart < numSamples; segmentStart += controlInterval)
+    {
+        const int segmentLength = juce::jmin(numSamples - segmentStart, controlInterval);
+        const auto activeModes = currentMode | (crossfadeRemaining > 0 ? previousMode : 0);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            dry[(size_t)channel] = buffer.getReadPointer(channel, segmentStart);
+            out[(size_t)channel] = buffer.getWritePointer(channel, segmentStart);
+            delayed[(size_t)channel] = dopplerBuffer.getReadPointer(channel);
+            fadingOut[(size_t)channel] = crossfadeBuffer.getWritePointer(channel);
+        }
+
+        // gain, filter coefficient and delay ramps of the segment, from the distance at its end
+        const auto needDelay = (activeModes & dopplerFlag) != 0;
+        updateSegmentCues(segmentStart, segmentLength, needDelay);
+        loadMeter.lap(LoadMeter::smoothing);
+
+        // doppler: the delay line is always fed so that enabling it is seamless, but only read when needed
+        if (needDelay)
+            dopplerDelay.process(dry.data(), dopplerBuffer.getArrayOfWritePointers(), segmentLength, delayRamp.data());
+        else
+            dopplerDelay.push(dry.data(), segmentLength);
+
+        loadMeter.lap(LoadMeter::delay);
+
+        if (crossfadeRemaining > 0)
+        {
+            // previous kernel into the scratch buffer, current kernel in place, then mix
+            runKernel(previousMode, previousBank, dry.data(), delayed.data(), fadingOut.data(), segmentLength);
+            runKernel(currentMode, currentBank, dry.data(), delayed.data(), out.data(), segmentLength);
+            applyCrossfade(out.data(), fadingOut.data(), segmentLength);
+        }
+        else
+        {
+            runKernel(currentMode, currentBank, dry.data(), delayed.data(), out.data(), segmentLength);
+        }
+
+        loadMeter.lap(LoadMeter::filter);
     }
 
     
@@ -250,7 +346,131 @@ void IOSONOSourceControlAudioProcessor::processBlock (juce::AudioBuffer<float>&
     //juce::dsp::ProcessContextReplacing<float> context(block);
     //int absorb = apvts.getRawParameterValue("AIR")->load();
     //if (absorb) lowpass.process(context);
-    
+
+    publishMetadata();
+    loadMeter.endBlock();
+}
+
+template <bool absorb, bool doppler>
+void IOSONOSourceControlAudioProcessor::processKernel(int filterBank, const float* const* dry, const float* const* delayed, float* const* out, int numSamples) noexcept
+{
+    // the filter is recursive, so it cannot be vectorised along time: channels go side by side in SIMD lanes instead.
+    // not worth the interleaving for a single channel, nor for the gain alone (the planar loop vectorises along time)
+    if constexpr (absorb)
+    {
+        if (numChannels > 1)
+        {
+            processLanes<doppler>(filterBank, dry, delayed, out, numSamples);
+            return;
+        }
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* in = doppler ? delayed[channel] : dry[channel];
+        auto* dest = out[channel];
+
+        for (int sample = 0; sample < numSamples; sample++)
+        {
+            auto value = in[sample];
+
+            // if air absorption, filter
+            if constexpr (absorb)
+                value = lowpass.processSample(filterBank + channel, value, coefficientRamp[(size_t)sample]);
+
+            // always attenuate
+            /**************** IOSONO Mode ****************/
+            /* when using the IOSONO renderer: gain attenuation using gainRamp should be removed, as it's already in the metadata  */
+            dest[sample] = gainRamp[(size_t)sample] * value;
+        }
+    }
+}
+
+template <bool doppler>
+void IOSONOSourceControlAudioProcessor::processLanes(int filterBank, const float* const* dry, const float* const* delayed, float* const* out, int numSamples) noexcept
+{
+    // same memory seen as floats: frame n, channel c at [n * laneGroups * laneWidth + c]. padding lanes are never written
+    auto* frames = laneFrames.data();
+    auto* samples = reinterpret_cast<float*>(frames);
+    const auto stride = laneGroups * laneWidth;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* in = doppler ? delayed[channel] : dry[channel];
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            samples[sample * stride + channel] = in[sample];
+    }
+
+    std::array<Register, maxLaneGroups> state;
+    lowpass.loadLanes(filterBank, numChannels, state.data());
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        const auto g = Register::expand(coefficientRamp[(size_t)sample]);
+        const auto gain = Register::expand(gainRamp[(size_t)sample]);
+        auto* frame = frames + sample * laneGroups;
+
+        for (int group = 0; group < laneGroups; ++group)
+            frame[group] = gain * AbsorptionFilter::processLanes(frame[group], g, state[(size_t)group]);
+    }
+
+    lowpass.storeLanes(filterBank, numChannels, state.data());
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* dest = out[channel];
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            dest[sample] = samples[sample * stride + channel];
+    }
+}
+
+void IOSONOSourceControlAudioProcessor::runKernel(int mode, int filterBank, const float* const* dry, const float* const* delayed, float* const* out, int numSamples) noexcept
+{
+    switch (mode)
+    {
+        case absorbFlag | dopplerFlag:  processKernel<true, true>   (filterBank, dry, delayed, out, numSamples); break;
+        case absorbFlag:                processKernel<true, false>  (filterBank, dry, delayed, out, numSamples); break;
+        case dopplerFlag:               processKernel<false, true>  (filterBank, dry, delayed, out, numSamples); break;
+        default:                        processKernel<false, false> (filterBank, dry, delayed, out, numSamples); break;
+    }
+}
+
+void IOSONOSourceControlAudioProcessor::startCrossfade(int newMode)
+{
+    if (((newMode ^ currentMode) & dopplerFlag) != 0)
+        setDistanceRamp(newMode);
+
+    previousMode = currentMode;
+    currentMode = newMode;
+    crossfadeRemaining = crossfadeSamples;
+
+    // the kernel being faded out carries on with the filter state, the new one starts from it (or from 0 if it was bypassed)
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        lowpass.copyState(currentBank + channel, previousBank + channel);
+
+        if ((previousMode & absorbFlag) == 0)
+            lowpass.resetChannel(currentBank + channel);
+    }
+}
+
+void IOSONOSourceControlAudioProcessor::applyCrossfade(float* const* out, const float* const* fadingOut, int numSamples) noexcept
+{
+    const auto step = 1.0f / (float)crossfadeSamples;
+    const auto start = (float)(crossfadeSamples - crossfadeRemaining) * step;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int sample = 0; sample < numSamples; sample++)
+        {
+            const auto fadeIn = juce::jmin(1.0f, start + (float)(sample + 1) * step);
+            out[channel][sample] = fadingOut[channel][sample] + fadeIn * (out[channel][sample] - fadingOut[channel][sample]);
+        }
+    }
+
+    crossfadeRemaining = juce::jmax(0, crossfadeRemaining - numSamples);
 }
 
 //==============================================================================
@@ -285,41 +505,308 @@ void IOSONOSourceControlAudioProcessor::setStateInformation (const void* data, i
 // This creates new instances of the plugin..
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
+   #if IOSONO_MULTI_SOURCE
+    return new IOSONOMultiSourceAudioProcessor();
+   #else
     return new IOSONOSourceControlAudioProcessor();
+   #endif
 }
 
 
-void IOSONOSourceControlAudioProcessor::calculateVolume()
+void IOSONOSourceControlAudioProcessor::updateDistanceCues(int numSamples)
 {
-    auto  currentRadius = apvts.getRawParameterValue("RADIUS")->load();
-    // auto  currentDist = apvts.getRawParameterValue("DIST")->load();
-    auto  currentFactor = apvts.getRawParameterValue("FACTOR")->load();
+    if (cueLawsChanged.exchange(false))
+        recomputeCues = true;
+
+    // OSC position input, evaluated at the block time. while a tracker is streaming it overrides the parameters.
+    // drained but ignored offline: a live tracker must not end up in a render
+    followingPositionInput = positionInput.getPosition(juce::Time::getMillisecondCounterHiRes(), inputPosition) && ! isNonRealtime();
+
+    // recorded log, at the transport time. it overrides the stream and the parameters
+    followingPlayback = updatePlayback();
+
+    // trajectory, evaluated for this block. it overrides everything else
+    followingTrajectory = updateTrajectory(numSamples);
 
-    volume = juce::jlimit(currentRadius, 300.0f, dist);
-    volume = pow(currentRadius / volume, currentFactor);
-    volume = juce::jlimit(0.0f, 1.0f, volume);
+    // along a trajectory: distance the sound heard at the end of the block travelled (the segments follow the exact delay)
+    dist = juce::jlimit(DistanceCues::kMinDistance, DistanceCues::kMaxDistance,
+                        followingTrajectory ? (float)trajectoryEnd.emission.distance
+                                            : followingPlayback ? playbackPosition.distance
+                                            : followingPositionInput ? inputPosition.distance : distParam->load());
+
+    // a change of source (stream, log, trajectory, parameters) ramps like any move
+    smoothDistance.setTargetValue(dist);
+}
+
+void IOSONOSourceControlAudioProcessor::updateTransport()
+{
+    transportSeconds = MetadataLog::getTransportSeconds(getPlayHead(), getSampleRate(), transportPlaying);
 }
 
-void IOSONOSourceControlAudioProcessor::calculateCutoff()
+bool IOSONOSourceControlAudioProcessor::loadPlayback(const juce::File& file)
 {
-    // Calculate cutoff frequency for specified atmospheric conditions (50% humidity, 20 degrees, at sea level)
-    air.FilterCutoffSolver(50, 20, air.kPressureSeaLevelPascals);
-    cutoff = juce::jlimit(20.0, 0.499 * getSampleRate(), air.cutoffSolve(dist, 3));
+    auto player = std::make_unique<MetadataLogPlayer>();
+
+    if (! player->open(file))
+        return false;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(playbackLock);
+        std::swap(playback, player);
+    }
+
+    // the previous player (and its prefetch thread) is deleted here, outside the lock
+    return true;
 }
 
-void IOSONOSourceControlAudioProcessor::calculateDelay()
+void IOSONOSourceControlAudioProcessor::clearPlayback()
 {
-    // auto  currentDist = apvts.getRawParameterValue("DIST")->load();
-    delayValue = dist * 2.94117647 * 0.001 * getSampleRate();
-    delayValue = juce::jlimit(1.0f, (float)maxDelaySamples, delayValue); // avoid a 0-sample delay
+    std::unique_ptr<MetadataLogPlayer> player;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(playbackLock);
+        std::swap(playback, player);
+    }
+}
+
+bool IOSONOSourceControlAudioProcessor::updatePlayback()
+{
+    const juce::SpinLock::ScopedTryLockType lock(playbackLock);
+
+    // being replaced right now: hold the last position for this block
+    if (! lock.isLocked())
+        return followingPlayback;
+
+    if (playback == nullptr || transportSeconds < 0.0)
+        return false;
+
+    // follows the transport whether it plays or not, so that a locate shows the recorded position
+    playback->advanceTo(transportSeconds);
+
+    SourceMetadata recorded;
+
+    if (! playback->getSource((int)indexParam->load(), recorded))
+        return false;
+
+    // the log holds what was sent: IOSONO azimuth, back to the usual convention (the conversion is its own inverse)
+    playbackPosition.azimuth = DistanceCues::toIosonoAzimuth(recorded.azimuth);
+    playbackPosition.elevation = recorded.elevation;
+    playbackPosition.distance = recorded.distance;
+    return true;
+}
+
+void IOSONOSourceControlAudioProcessor::setTrajectory(std::unique_ptr<Trajectory> newTrajectory)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(trajectoryLock);
+        std::swap(trajectory, newTrajectory);
+        trajectoryRestart = true;
+    }
+
+    // the previous trajectory is deleted here, outside the lock
+}
+
+bool IOSONOSourceControlAudioProcessor::updateTrajectory(int numSamples)
+{
+    const auto sampleRate = getSampleRate();
+    const juce::SpinLock::ScopedTryLockType lock(trajectoryLock);
+
+    if (! lock.isLocked())
+    {
+        // being replaced right now: carry on along the current delay slope, the new trajectory starts at the next block
+        if (followingTrajectory)
+        {
+            trajectoryDelay = { trajectoryEnd.delay * sampleRate, trajectoryEnd.delayRate * numSamples, 0.0, 0.0 };
+            trajectoryBlockSize = juce::jmax(1, numSamples);
+            trajectoryEnd.delay += trajectoryEnd.delayRate * numSamples / sampleRate;
+            trajectoryEndValid = false;
+        }
+
+        return followingTrajectory;
+    }
+
+    if (trajectory == nullptr)
+    {
+        trajectoryEndValid = false;
+        return false;
+    }
+
+    if (trajectoryRestart)
+    {
+        trajectoryRestart = false;
+        trajectoryTime = 0.0;
+        trajectoryEndValid = false;
+    }
+
+    // position now, for the metadata (time-tagged with the delay it is heard after, like the parameters)
+    const auto now = trajectory->evaluate(trajectoryTime);
+    trajectoryPosition.azimuth = now.azimuth();
+    trajectoryPosition.elevation = now.elevation();
+    trajectoryPosition.distance = (float)now.distance;
+
+    // propagation at both ends of the block: the end of this one is the start of the next
+    const auto start = trajectoryEndValid ? trajectoryEnd : trajectory->propagationAt(trajectoryTime);
+    trajectoryTime += (double)numSamples / sampleRate;
+    trajectoryEnd = trajectory->propagationAt(trajectoryTime);
+    trajectoryEndValid = true;
+
+    // delay over the block: cubic Hermite through both ends, with the slopes given by the radial velocity
+    const auto d0 = start.delay * sampleRate;
+    const auto d1 = trajectoryEnd.delay * sampleRate;
+    const auto m0 = start.delayRate * numSamples;
+    const auto m1 = trajectoryEnd.delayRate * numSamples;
+    trajectoryDelay = { d0, m0, 3.0 * (d1 - d0) - 2.0 * m0 - m1, 2.0 * (d0 - d1) + m0 + m1 };
+    trajectoryBlockSize = juce::jmax(1, numSamples);
+    return true;
+}
+
+float IOSONOSourceControlAudioProcessor::trajectoryDelayAt(int blockOffset) const noexcept
+{
+    const auto u = (double)blockOffset / (double)trajectoryBlockSize;
+    const auto delay = trajectoryDelay[0] + u * (trajectoryDelay[1] + u * (trajectoryDelay[2] + u * trajectoryDelay[3]));
+    return juce::jlimit(1.0f, maxDelaySamples, (float)delay - delayCompensation); // avoid a 0-sample delay
+}
+
+void IOSONOSourceControlAudioProcessor::fillTrajectoryDelay(int blockOffset, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; i++)
+        delayRamp[(size_t)i] = trajectoryDelayAt(blockOffset + i);
+}
+
+void IOSONOSourceControlAudioProcessor::updateSegmentCues(int blockOffset, int numSamples, bool needDelay) noexcept
+{
+    const auto sampleRate = getSampleRate();
+    const auto last = (size_t)numSamples - 1;
+    float endDistance, endDelay;
+
+    // distance at the end of the segment. along a trajectory: the one the exact delay was travelled over
+    if (followingTrajectory)
+    {
+        if (needDelay)
+            fillTrajectoryDelay(blockOffset, numSamples);
+
+        endDelay = needDelay ? delayRamp[last] : trajectoryDelayAt(blockOffset + numSamples - 1);
+        endDistance = (endDelay + delayCompensation) / (DistanceCues::kSecondsPerMeter * (float)sampleRate);
+        smoothDistance.setCurrentAndTargetValue(juce::jlimit(DistanceCues::kMinDistance, DistanceCues::kMaxDistance, endDistance));
+    }
+    else
+    {
+        endDistance = smoothDistance.skip(numSamples);
+        endDelay = DistanceCues::delayForDistance(endDistance, sampleRate, maxDelaySamples, delayCompensation);
+    }
+
+    // static source: constant cues, no pow / tan
+    if (endDistance == segmentDistance && ! recomputeCues)
+    {
+        std::fill(gainRamp.begin(), gainRamp.begin() + numSamples, segmentGain);
+
+        if (needDelay && ! followingTrajectory)
+            std::fill(delayRamp.begin(), delayRamp.begin() + numSamples, segmentDelay);
+
+        lowpass.fillCoefficients(coefficientRamp.data(), numSamples);
+        return;
+    }
+
+    recomputeCues = false;
+
+    // the three cues from the same distance, interpolated linearly over the segment
+    const auto endGain = DistanceCues::gainForDistance(endDistance, radiusParam->load(), factorParam->load());
+    const auto endCutoff = juce::jlimit(20.0, 0.499 * sampleRate, (double)air.cutoffFor(juce::jmin(endDistance, DistanceCues::kMaxDistance)));
+    lowpass.rampCutoffFrequency((float)endCutoff, numSamples);
+    lowpass.fillCoefficients(coefficientRamp.data(), numSamples);
+
+    const auto scale = 1.0f / (float)numSamples;
+    const auto gainStep = (endGain - segmentGain) * scale;
+
+    for (int i = 0; i < numSamples; ++i)
+        gainRamp[(size_t)i] = segmentGain + gainStep * (float)(i + 1);
+
+    if (needDelay && ! followingTrajectory)
+    {
+        const auto delayStep = (endDelay - segmentDelay) * scale;
+
+        for (int i = 0; i < numSamples; ++i)
+            delayRamp[(size_t)i] = segmentDelay + delayStep * (float)(i + 1);
+    }
+
+    segmentDistance = endDistance;
+    segmentGain = endGain;
+    segmentDelay = endDelay;
+}
+
+int IOSONOSourceControlAudioProcessor::getCompensationSamples(double sampleRate) const
+{
+    // nothing to compensate without the delay line
+    if (dopplerParam->load() < 0.5f || latencyCompensationParam->load() < 0.5f)
+        return 0;
+
+    return juce::jmin(DistanceCues::latencyForReference(latencyReferenceParam->load(), sampleRate), (int)maxDelaySamples);
+}
+
+void IOSONOSourceControlAudioProcessor::handleAsyncUpdate()
+{
+    // message thread: the latency is reported to the host here, never from processBlock
+    const auto compensation = getCompensationSamples(getSampleRate());
+    reportedCompensation.store(compensation);
+    setLatencySamples(compensation);
+
+    // the ring of the new INDEX is created here too, not on the thread that changed the parameter
+    if (transportChanged.exchange(false))
+        applyTransport((int)indexParam->load());
+
+    if (atmosphereChanged.exchange(false))
+        rebuildCutoffTable();
+}
+
+void IOSONOSourceControlAudioProcessor::updateLatency()
+{
+    const auto compensation = (float)reportedCompensation.load();
+
+    if (compensation == delayCompensation)
+        return;
+
+    // the host moves the track by the latency difference at once: the line jumps with it rather than gliding (no pitch sweep)
+    segmentDelay = juce::jlimit(1.0f, maxDelaySamples, segmentDelay + delayCompensation - compensation);
+    delayCompensation = compensation;
+}
+
+void IOSONOSourceControlAudioProcessor::setDistanceRamp(int mode)
+{
+    // SmoothedValue::reset jumps to the target: carry on from where the ramp was
+    const auto current = smoothDistance.getCurrentValue();
+    const auto target = smoothDistance.getTargetValue();
+
+    smoothDistance.reset(getSampleRate(), (mode & dopplerFlag) != 0 ? dopplerRampSeconds : levelRampSeconds);
+    smoothDistance.setCurrentAndTargetValue(current);
+    smoothDistance.setTargetValue(target);
+}
+
+void IOSONOSourceControlAudioProcessor::rebuildCutoffTable()
+{
+    // coalesce bursts of atmosphere automation into a single rebuild
+    if (cutoffTableRebuildPending.exchange(true))
+        return;
+
+    tableBuilder.addJob([this]
+        {
+            cutoffTableRebuildPending.store(false);
+
+            auto humidity    = apvts.getRawParameterValue("HUMIDITY")->load();
+            auto temperature = apvts.getRawParameterValue("TEMP")->load();
+            auto pressure    = apvts.getRawParameterValue("PRESSURE")->load() * 100.0; // hPa to Pa
+
+            air.FilterCutoffSolver(humidity, temperature, pressure);
+            air.buildCutoffTable(AirAbsorption::kDefaultCutoffGain);
+            cueLawsChanged.store(true);
+        });
 }
 
 void IOSONOSourceControlAudioProcessor::calculateAzimuth()
 {
     // convert from "usual" conventions - 0 deg in front, clockwise- to IOSONO - 0 deg to the right, anticlockwise -
-    azimuth = apvts.getRawParameterValue("AZIM")->load();
-    azimuth = 90.0f - 1.0f * azimuth;
-    if (azimuth < 0) azimuth += 360.0f; // wrap around
+    const auto* position = followingTrajectory ? &trajectoryPosition : followingPlayback ? &playbackPosition
+                         : followingPositionInput ? &inputPosition : nullptr;
+    azimuth = DistanceCues::toIosonoAzimuth(position != nullptr ? position->azimuth : azimuthParam->load());
 
     // TODO convert to radians .. 
     // azimuth *= 0.01745329251;
@@ -340,6 +827,14 @@ juce::AudioProcessorValueTreeState::ParameterLayout IOSONOSourceControlAudioProc
     params.push_back(std::make_unique<juce::AudioParameterFloat>    ("FACTOR", "factor", 0.0f, 10.0f, 1.0f));
     params.push_back(std::make_unique<juce::AudioParameterInt>      ("AIR", "air", 0, 1, 0));
     params.push_back(std::make_unique<juce::AudioParameterInt>      ("DOPPLER", "doppler", 0, 1, 0));
+    params.push_back(std::make_unique<juce::AudioParameterInt>      ("LATCOMP", "doppler latency compensation", 0, 1, 0));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("LATREF", "latency reference distance", juce::NormalisableRange<float>(0.0f, 300.0f, 0.01f, 0.5f), 1.0f)); // m, e.g. the closest source of the session
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("HUMIDITY", "humidity", 0.0f, 100.0f, 50.0f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("TEMP", "temperature", -20.0f, 50.0f, 20.0f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("PRESSURE", "pressure", 800.0f, 1100.0f, 1013.25f)); // hPa
+    params.push_back(std::make_unique<juce::AudioParameterInt>      ("TIMETAG", "osc time tags", 0, 1, 0));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("OUTLATENCY", "output latency", 0.0f, 1000.0f, 0.0f)); // ms, host + device
+    params.push_back(std::make_unique<juce::AudioParameterFloat>    ("PRIORITY", "send priority", 0.0f, 10.0f, 1.0f)); // weight when the packet budget is short
 
     return { params.begin(), params.end() };
 
@@ -351,62 +846,95 @@ juce::AudioProcessorValueTreeState::ParameterLayout IOSONOSourceControlAudioProc
 
 void IOSONOSourceControlAudioProcessor::oscConnect()
 {
-    oscMessageSender.connect("127.0.0.1", 9001);
+    metadataSender.connect("127.0.0.1", 9001);
 }
 
-void IOSONOSourceControlAudioProcessor::sendMetadata()
+bool IOSONOSourceControlAudioProcessor::setSharedMemoryTransport(bool shouldUseSharedMemory, bool alsoSendUdp)
 {
-    // juce::String address = juce::String::formatted("/source/%d/aed", sourceIndex); // old test, spat osc address format
-    juce::OSCAddressPattern oscAddress("/iosono/renderer/version1/src");
-    juce::OSCMessage oscMessage(oscAddress);
+    sharedMemoryEnabled.store(shouldUseSharedMemory);
+    sharedMemoryUdp.store(alsoSendUdp);
+    return applyTransport((int)indexParam->load());
+}
+
+bool IOSONOSourceControlAudioProcessor::applyTransport(int index)
+{
+    // one ring per instance, named after the source index. two instances on the same INDEX: the second one is refused
+    if (! sharedMemoryEnabled.load())
+    {
+        sharedMemoryOpen.store(false);
+        return metadataSender.useSharedMemory({}, true);
+    }
 
+    const auto opened = metadataSender.useSharedMemory("iosono-metadata-" + juce::String(index), sharedMemoryUdp.load());
+    sharedMemoryOpen.store(opened);
+    return opened;
+}
 
-    auto elev = apvts.getRawParameterValue("ELEV")->load();
-    auto dist = apvts.getRawParameterValue("DIST")->load();
-    auto type = apvts.getRawParameterValue("TYPE")->load();
-    auto idx = apvts.getRawParameterValue("INDEX")->load();
-    
-    // calculateVolume();
+void IOSONOSourceControlAudioProcessor::publishMetadata()
+{
+    // juce::String address = juce::String::formatted("/source/%d/aed", sourceIndex); // old test, spat osc address format
     calculateAzimuth();
 
-    // IOSONO UDP Packet 
-    // /iosono/renderer/version1/src #source_index #source_type #azim #elev #dist #volume 0. 0. 0 0 0. 0
-    
-    oscMessage.addInt32(idx);
-    oscMessage.addInt32(type - 1);
-    oscMessage.addFloat32(azimuth);
-    oscMessage.addFloat32(elev);
-    oscMessage.addFloat32(dist);
-    oscMessage.addFloat32(volume);
-    oscMessage.addFloat32(0.0f);
-    oscMessage.addFloat32(0.0f);
-    oscMessage.addInt32(0);
-    oscMessage.addInt32(0);
-    oscMessage.addFloat32(0.0f);
-    oscMessage.addInt32(0);
+    // trajectory, then recorded log, then OSC stream, then parameters
+    const auto* position = followingTrajectory ? &trajectoryPosition : followingPlayback ? &playbackPosition
+                         : followingPositionInput ? &inputPosition : nullptr;
+
+    SourceMetadata source;
+    source.index     = (int)indexParam->load();
+    source.type      = (int)typeParam->load() - 1;
+    source.azimuth   = azimuth;
+    source.elevation = position != nullptr ? position->elevation : elevationParam->load();
+    source.distance  = position != nullptr ? position->distance : distParam->load();
+    source.volume    = segmentGain;
+    source.transportSeconds = transportPlaying ? transportSeconds : -1.0;
+
+    // time tag: when the audio of this block is heard, i.e. after the output latency and the doppler delay it went through
+    // (the line delay only: the compensated part is absorbed by the host, which plays this track that much earlier)
+    if (timeTagParam->load() > 0.5f && blockTimeMs > 0.0)
+    {
+        const auto dopplerMs = dopplerParam->load() * segmentDelay * 1000.0 / getSampleRate();
+        source.timeMs = blockTimeMs + outputLatencyParam->load() + dopplerMs;
+    }
 
-    oscMessageSender.send(oscMessage);
+    // lock-free, picked up by the sender thread
+    currentMetadata = source;
+    metadataSender.publish(0, source);
 }
 
 
 void IOSONOSourceControlAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
 {
-    if (parameterID == "DIST")
+    // may be called from any thread: only flag what needs recomputing, the audio thread does it at the next segment
+    if (parameterID == "RADIUS" || parameterID == "FACTOR")
     {
-        dist = juce::jlimit(0.1f, 300.0f, newValue);
-        calculateVolume();
-        calculateCutoff();
-        calculateDelay();
+        cueLawsChanged.store(true);
     }
-    
-    if (parameterID == "RADIUS")
+
+    if (parameterID == "HUMIDITY" || parameterID == "TEMP" || parameterID == "PRESSURE")
     {
-        calculateVolume();
+        atmosphereChanged.store(true);
+        triggerAsyncUpdate();
     }
 
-    if (parameterID == "FACTOR")
+    if (parameterID == "DOPPLER" || parameterID == "LATCOMP" || parameterID == "LATREF")
     {
-        calculateVolume();
+        triggerAsyncUpdate();
+    }
+
+    if (parameterID == "PRIORITY")
+    {
+        metadataSender.setPriority(0, newValue);
+    }
+
+    if (parameterID == "INDEX")
+    {
+        metadataSender.listen(controlPortBase + (int)newValue);
+
+        if (sharedMemoryEnabled.load())
+        {
+            transportChanged.store(true);
+            triggerAsyncUpdate();
+        }
     }
 
 }
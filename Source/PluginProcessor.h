@@ -10,14 +10,23 @@
 
 #include <JuceHeader.h>
 #include "AirAbsorption.h"
+#include "AbsorptionFilter.h"
+#include "DistanceCues.h"
+#include "MetadataSenderThread.h"
+#include "AudioClock.h"
+#include "DopplerDelay.h"
+#include "LoadMeter.h"
+#include "PositionInput.h"
+#include "Trajectory.h"
+#include "MetadataLog.h"
 
 
 //==============================================================================
 /**
 */
 class IOSONOSourceControlAudioProcessor  : public juce::AudioProcessor,
-    private juce::Timer,
-    private juce::AudioProcessorValueTreeState::Listener
+    private juce::AudioProcessorValueTreeState::Listener,
+    private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -34,6 +43,9 @@ public:
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
+    /* offline renders run faster than real time: the OSC thread is stopped and the position input ignored meanwhile */
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -59,24 +71,89 @@ public:
 
     juce::AudioProcessorValueTreeState apvts;
 
+    /* number of samples between two derivations of gain, filter coefficient and delay from the smoothed distance (interpolated in between) */
+    void setCutoffUpdateInterval(int numSamples) { cutoffUpdateInterval.store(juce::jlimit(1, maxSegmentSize, numSamples)); }
+
+    /* doppler delay memory, applied at the next prepareToPlay: the line is sized for this distance at the
+       current sample rate, and can be stored in 16 bit to halve its footprint */
+    void setDopplerMaximumDistance(float meters) { dopplerMaximumDistance.store(juce::jlimit(1.0f, 2000.0f, meters)); }
+    void setDopplerCompactStorage(bool shouldUseCompactStorage) { dopplerCompactStorage.store(shouldUseCompactStorage); }
+
+    /* DSP load of this instance, any thread. false until the first half second of audio was measured */
+    bool getLoadStats(LoadMeter::Stats& stats) const { return loadMeter.getStats(stats); }
+
+    /* OSC position input (/iosono/position): messages are rendered this late, interpolated. 0: dead reckoning, lowest latency */
+    void setPositionInterpolationDelay(double milliseconds) { positionInput.setInterpolationDelay(milliseconds); }
+
+    /* the source follows this path from now on (time 0 = the next block), overriding the OSC position input and AZIM / ELEV / DIST.
+       doppler delay, level, filter and metadata come from the exact propagation along the path. nullptr: back to the parameters.
+       any thread but the audio thread: the previous trajectory is deleted here */
+    void setTrajectory(std::unique_ptr<Trajectory> newTrajectory);
+
+    /* metadata written to the shared memory ring "iosono-metadata-<INDEX>" (SharedMetadataRing.h) for a renderer / bridge
+       on this machine, with or without the UDP messages. message thread (the ring is created here).
+       false if the ring cannot be created, e.g. another running instance writes it: the metadata stays on UDP */
+    bool setSharedMemoryTransport(bool shouldUseSharedMemory, bool alsoSendUdp = false);
+
+    /* false when the shared memory transport is on but has no ring, e.g. after INDEX moved to a ring in use. any thread */
+    bool isSharedMemoryOpen() const noexcept { return sharedMemoryOpen.load(); }
+
+    /* records the metadata as sent, stamped with the host transport time, while the transport plays (MetadataLog.h).
+       playing the same section again records over it. any thread */
+    void startRecording(const juce::File& file) { metadataSender.startRecording(file); }
+    void stopRecording() { metadataSender.stopRecording(); }
+
+    /* the source follows the positions recorded for its INDEX in this log, in sync with the host transport,
+       overriding the OSC position input and AZIM / ELEV / DIST (a trajectory still wins). false if the file is not a log.
+       message thread: the previous player is deleted here */
+    bool loadPlayback(const juce::File& file);
+    void clearPlayback();
+
+    /* metadata of the last block, as published to the OSC thread. audio thread, or the thread rendering offline */
+    const SourceMetadata& getCurrentMetadata() const noexcept { return currentMetadata; }
+
+    /* same, from any thread without locking: the last block published to the OSC thread. false before the first one */
+    bool getDisplayMetadata(SourceMetadata& source) const noexcept { return metadataSender.readLatest(0, source); }
+
+    /* OSC load queries and positions are received on controlPortBase + INDEX */
+    static constexpr int controlPortBase = 9100;
+
 private:
     AirAbsorption air;
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameters();
 
     void oscConnect();
-    void sendMetadata();
-    void timerCallback() final
-    {
-      sendMetadata();
-    }
+    bool applyTransport(int index);
+    void publishMetadata();
 
     void parameterChanged(const juce::String& parameterID, float newValue);
+    void handleAsyncUpdate() override;
 
-    void calculateVolume();
-    void calculateCutoff();
-    void calculateDelay();
+    void updateTransport();
+    void updateDistanceCues(int numSamples);
+    bool updatePlayback();
+    bool updateTrajectory(int numSamples);
+    void fillTrajectoryDelay(int blockOffset, int numSamples) noexcept;
+    float trajectoryDelayAt(int blockOffset) const noexcept;
+    void updateSegmentCues(int blockOffset, int numSamples, bool needDelay) noexcept;
+    void setDistanceRamp(int mode);
+    int getCompensationSamples(double sampleRate) const;
+    void updateLatency();
     void calculateAzimuth();
+    void rebuildCutoffTable();
+
+    /* processing kernels, one per AIR / DOPPLER combination. bypassed stages are not compiled in */
+    enum ProcessingMode { plainGain = 0, absorbFlag = 1, dopplerFlag = 2 };
+
+    template <bool absorb, bool doppler>
+    void processKernel(int filterBank, const float* const* dry, const float* const* delayed, float* const* out, int numSamples) noexcept;
+    template <bool doppler>
+    void processLanes(int filterBank, const float* const* dry, const float* const* delayed, float* const* out, int numSamples) noexcept;
+    void runKernel(int mode, int filterBank, const float* const* dry, const float* const* delayed, float* const* out, int numSamples) noexcept;
+
+    void startCrossfade(int newMode);
+    void applyCrossfade(float* const* out, const float* const* fadingOut, int numSamples) noexcept;
 
     int sourceIndex = 1;
     int sourceType = 0;
@@ -86,25 +163,137 @@ private:
     float elevation = 0.0f;
     float dist = 1.0f;
 
-    float volume = 0.0f;
-    float cutoff = 20000.0f;
-    float delayValue = 0.0f;
+    /* RADIUS / FACTOR or the atmosphere changed: set by the parameter listener / cutoff table builder,
+       the cues are recomputed at the next segment even if the distance does not move */
+    std::atomic<bool> cueLawsChanged { true };
+    bool recomputeCues = true;
+
+    std::atomic<float>* distParam = nullptr;
+    std::atomic<float>* radiusParam = nullptr;
+    std::atomic<float>* factorParam = nullptr;
+
+    /* read every block for the metadata (publishMetadata, updatePlayback), looked up once in the constructor */
+    std::atomic<float>* indexParam = nullptr;
+    std::atomic<float>* typeParam = nullptr;
+    std::atomic<float>* azimuthParam = nullptr;
+    std::atomic<float>* elevationParam = nullptr;
+    std::atomic<float>* timeTagParam = nullptr;
+    std::atomic<float>* outputLatencyParam = nullptr;
+
+    /* latency compensated doppler (LATCOMP): the delay of LATREF meters is taken out of the line and reported to the host.
+       DOPPLER, LATCOMP or LATREF changed: recomputed and reported on the message thread (handleAsyncUpdate),
+       the audio thread only picks up the published value and moves the line at the next block */
+    std::atomic<float>* latencyCompensationParam = nullptr;
+    std::atomic<float>* latencyReferenceParam = nullptr;
+    std::atomic<int> reportedCompensation { 0 };   // samples, as reported to the host
+    float delayCompensation = 0.0f;                 // samples, taken out of the line, audio thread
 
     
     /* instantiate filter */
-    juce::dsp::FirstOrderTPTFilter<float> lowpass;
+    AbsorptionFilter lowpass;
+    std::atomic<int> cutoffUpdateInterval { 32 };
 
     /* instantiate delay line */
-    static constexpr auto maxDelaySamples = 192000; // 4 seconds @48 kHz => max distance of 1360 meters
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Lagrange3rd> LagrangeDelay { maxDelaySamples };
+    std::atomic<float> dopplerMaximumDistance { DistanceCues::kMaxDistance };  // DIST range by default
+    std::atomic<bool> dopplerCompactStorage { false };
+    float maxDelaySamples = 1.0f;   // computed in prepareToPlay from the sample rate and dopplerMaximumDistance
+    DopplerDelay<DopplerInterpolation::Selected> dopplerDelay;   // IOSONO_DOPPLER_INTERPOLATION
+
+    /* channels processed, one source on all of them: 1 for a mono source (half the work of stereo), up to maxChannels */
+    static constexpr int maxChannels = 64;
+    int numChannels = 2;
+
+    /* per segment scratch: ramps, delayed signal, output of the kernel being faded out */
+    static constexpr int maxSegmentSize = 256;
+    std::vector<float> delayRamp;
+    std::vector<float> gainRamp;
+    std::vector<float> coefficientRamp;
+    juce::AudioBuffer<float> dopplerBuffer;
+    juce::AudioBuffer<float> crossfadeBuffer;
+
+    /* filter kernels with more than one channel: the segment interleaved in SIMD lanes, laneGroups registers per frame
+       (laneWidth channels each, padding lanes at 0), so that laneWidth channels are filtered for the cost of one */
+    using Register = AbsorptionFilter::Register;
+    static constexpr int laneWidth = AbsorptionFilter::laneWidth;
+    static constexpr int maxLaneGroups = (maxChannels + laneWidth - 1) / laneWidth;
+    int laneGroups = 1;
+    std::vector<Register> laneFrames;
+
+    /* kernel selection, with a short crossfade when AIR or DOPPLER is toggled */
+    std::atomic<float>* airParam = nullptr;
+    std::atomic<float>* dopplerParam = nullptr;
+    int currentMode = plainGain;
+    int previousMode = plainGain;
+    int crossfadeSamples = 1;
+    int crossfadeRemaining = 0;
+    static constexpr int currentBank = 0;   // filter channels 0 to numChannels - 1
+    int previousBank = 2;                   // filter channels numChannels to 2 numChannels - 1, used by the kernel being faded out
+
+    /* a single smoother, on the distance. gain, cutoff and delay are derived from it once per control period
+       (cutoffUpdateInterval) and interpolated in between, so that level, filter and doppler move together.
+       the ramp is the doppler one while DOPPLER is on (the delay must not jump), the level one otherwise */
+    static constexpr double levelRampSeconds = 0.02;
+    static constexpr double dopplerRampSeconds = 0.15;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothDistance;
 
-    /* instantiate smoothers */
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothAmp;
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothCutoff;
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothDelay;
+    /* cues at the end of the last segment, i.e. at the start of the next one */
+    float segmentDistance = 1.0f;
+    float segmentGain = 0.0f;
+    float segmentDelay = 1.0f;  // samples
     
-    /* instantiate OSC message sender */
-    juce::OSCSender oscMessageSender;
+    /* time per block and per stage vs the real-time budget, read by the sender thread: declared before it */
+    LoadMeter loadMeter;
+
+    /* positions streamed over OSC, fed by the receiver thread: declared before it too.
+       while a stream is active (less than 1 s since the last message) it overrides AZIM / ELEV / DIST */
+    PositionInput positionInput;
+    PositionInput::Position inputPosition;
+    bool followingPositionInput = false;
+
+    /* trajectory, swapped under the lock by setTrajectory. the audio thread only try-locks it,
+       and carries on along the current delay slope for the block in the unlikely case it is being replaced */
+    juce::SpinLock trajectoryLock;
+    std::unique_ptr<Trajectory> trajectory;
+    bool trajectoryRestart = false;         // guarded by trajectoryLock
+
+    /* audio thread: time along the trajectory, propagation at the end of the block (= start of the next one),
+       and the doppler delay over the block, in samples, as a cubic in (sample / block size) */
+    double trajectoryTime = 0.0;
+    Trajectory::Propagation trajectoryEnd;
+    bool trajectoryEndValid = false;
+    std::array<double, 4> trajectoryDelay {};
+    int trajectoryBlockSize = 1;
+    PositionInput::Position trajectoryPosition;
+    bool followingTrajectory = false;
+
+    /* log playback, swapped under the lock like the trajectory. the audio thread only try-locks it,
+       and keeps the last position for the block in the unlikely case it is being replaced */
+    juce::SpinLock playbackLock;
+    std::unique_ptr<MetadataLogPlayer> playback;
+    PositionInput::Position playbackPosition;
+    bool followingPlayback = false;
+
+    /* host transport of the current block, -1 when the host gives none */
+    double transportSeconds = -1.0;
+    bool transportPlaying = false;
+
+    /* OSC message sender, runs on its own thread */
+    MetadataSenderThread metadataSender;
+    SourceMetadata currentMetadata;
+    std::atomic<bool> sharedMemoryEnabled { false };
+    std::atomic<bool> sharedMemoryUdp { false };
+    std::atomic<bool> sharedMemoryOpen { false };
+    std::atomic<bool> transportChanged { false };  // INDEX changed: the ring is renamed on the message thread
+
+    /* time of the current block, for the OSC time tags */
+    AudioClock audioClock;
+    double blockTimeMs = 0.0;
+
+    /* background thread solving the cutoff table when the atmosphere changes.
+       the job is queued from handleAsyncUpdate: addJob allocates and locks, the listener may run on the audio thread */
+    juce::ThreadPool tableBuilder { 1 };
+    std::atomic<bool> atmosphereChanged { false };
+    std::atomic<bool> cutoffTableRebuildPending { false };
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IOSONOSourceControlAudioProcessor)
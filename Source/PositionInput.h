@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    PositionInput.h
+    Created: 21 Oct 2026 4:48:09pm
+    @Author:  regnier
+    @Brief: High rate position input (trackers, MAX patches at 100-500 Hz), bypassing the APVTS.
+    The OSC receiver thread pushes time-stamped positions into a lock-free single producer / single consumer FIFO,
+    the audio thread drains it once per block and evaluates the position at the block time:
+    --> interpolated between the two messages around (now - interpolation delay), which hides the network jitter
+    --> or, with a delay of 0 (or when the stream is late), dead-reckoned from the last two messages, for a limited time
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+class PositionInput
+{
+    public:
+
+        /* usual conventions, same as the AZIM / ELEV / DIST parameters */
+        struct Position
+        {
+            float azimuth = 0.0f;   // degrees, 0 in front, clockwise
+            float elevation = 0.0f; // degrees
+            float distance = 1.0f;  // meters
+            double timeMs = 0.0;    // arrival, juce::Time::getMillisecondCounterHiRes()
+        };
+
+        /* receiver thread. false when the FIFO is full (the audio thread is not running), the message is dropped */
+        bool push(const Position& position) noexcept
+        {
+            const auto scope = fifo.write(1);
+
+            if (scope.blockSize1 + scope.blockSize2 == 0)
+                return false;
+
+            auto& dest = buffer[(size_t)(scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)];
+            dest = position;
+            dest.azimuth -= 360.0f * std::floor(dest.azimuth / 360.0f);
+            dest.elevation = juce::jlimit(-90.0f, 90.0f, dest.elevation);
+            return true;
+        }
+
+        /* any thread, applied at the next block */
+        void setInterpolationDelay(double milliseconds) noexcept { interpolationDelayMs.store(juce::jlimit(0.0, 200.0, milliseconds)); }
+
+        /* audio thread: forget the history, e.g. in prepareToPlay. the FIFO itself is drained at the next block */
+        void reset() noexcept
+        {
+            historySize = 0;
+        }
+
+        /* audio thread, once per block. returns false when no position arrived for timeoutMs:
+           the caller then falls back to the parameters */
+        bool getPosition(double nowMs, Position& position) noexcept
+        {
+            drain();
+
+            if (historySize == 0 || nowMs - newest().timeMs > timeoutMs)
+                return false;
+
+            const auto t = nowMs - interpolationDelayMs.load(std::memory_order_relaxed);
+
+            // past the newest message: dead reckoning, from the velocity between the last two
+            if (t >= newest().timeMs)
+            {
+                position = newest();
+
+                if (historySize >= 2)
+                {
+                    const auto& previous = at(historySize - 2);
+                    const auto interval = newest().timeMs - previous.timeMs;
+
+                    if (interval > 0.0)
+                    {
+                        const auto amount = (float)(juce::jmin(t - newest().timeMs, maxExtrapolationMs) / interval);
+                        position = lerp(previous, newest(), 1.0f + amount);
+                        position.distance = juce::jmax(0.0f, position.distance);
+                    }
+                }
+
+                return true;
+            }
+
+            // older than the history: hold the oldest
+            if (t <= at(0).timeMs)
+            {
+                position = at(0);
+                return true;
+            }
+
+            // interpolation between the two messages around t
+            for (int i = historySize - 1; i > 0; --i)
+            {
+                const auto& before = at(i - 1);
+                const auto& after = at(i);
+
+                if (t >= before.timeMs)
+                {
+                    const auto interval = after.timeMs - before.timeMs;
+                    position = lerp(before, after, interval > 0.0 ? (float)((t - before.timeMs) / interval) : 1.0f);
+                    return true;
+                }
+            }
+
+            position = newest();
+            return true;
+        }
+
+    private:
+
+        static constexpr int capacity = 512;            // 1 s at 500 Hz
+        static constexpr int maxHistory = 8;
+        static constexpr double timeoutMs = 1000.0;
+        static constexpr double maxExtrapolationMs = 50.0;
+
+        void drain() noexcept
+        {
+            const auto scope = fifo.read(fifo.getNumReady());
+
+            for (int i = 0; i < scope.blockSize1; ++i)
+                append(buffer[(size_t)(scope.startIndex1 + i)]);
+
+            for (int i = 0; i < scope.blockSize2; ++i)
+                append(buffer[(size_t)(scope.startIndex2 + i)]);
+        }
+
+        void append(const Position& position) noexcept
+        {
+            // out of order (clock or thread hiccup): keep the history sorted by dropping it
+            if (historySize > 0 && position.timeMs < newest().timeMs)
+                return;
+
+            if (historySize == maxHistory)
+            {
+                historyStart = (historyStart + 1) % maxHistory;
+                --historySize;
+            }
+
+            history[(size_t)((historyStart + historySize) % maxHistory)] = position;
+            ++historySize;
+        }
+
+        /* i = 0 is the oldest */
+        const Position& at(int i) const noexcept { return history[(size_t)((historyStart + i) % maxHistory)]; }
+        const Position& newest() const noexcept { return at(historySize - 1); }
+
+        static Position lerp(const Position& a, const Position& b, float amount) noexcept
+        {
+            // azimuth along the shortest arc
+            auto azimuthDelta = b.azimuth - a.azimuth;
+            if (azimuthDelta > 180.0f)   azimuthDelta -= 360.0f;
+            if (azimuthDelta < -180.0f)  azimuthDelta += 360.0f;
+
+            Position p;
+            p.azimuth = a.azimuth + amount * azimuthDelta;
+            p.azimuth -= 360.0f * std::floor(p.azimuth / 360.0f);
+            p.elevation = juce::jlimit(-90.0f, 90.0f, a.elevation + amount * (b.elevation - a.elevation));
+            p.distance = a.distance + amount * (b.distance - a.distance);
+            p.timeMs = a.timeMs + amount * (b.timeMs - a.timeMs);
+            return p;
+        }
+
+        /* receiver -> audio thread */
+        juce::AbstractFifo fifo { capacity };
+        std::array<Position, capacity> buffer;
+
+        std::atomic<double> interpolationDelayMs { 10.0 };
+
+        /* audio thread only */
+        std::array<Position, maxHistory> history;
+        int historyStart = 0;
+        int historySize = 0;
+};
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    SendScheduler.h
+    Created: 22 Oct 2026 3:05:22pm
+    @Author:  regnier
+    @Brief: Picks which sources the OSC thread sends at each round, instead of one packet per source every 20 ms.
+    The thread runs at the maximum rate (500 Hz by default). A source is due when it moved by more than its dead-band
+    since it was last sent (so the rate follows its speed, capped at the maximum rate), or when its keep-alive is due
+    (heartbeat when static). A token bucket enforces a packet budget for the whole process (PacketBudget, shared by
+    every plugin instance the host loaded in it): when more sources are due than the budget allows, the most urgent
+    ones of an instance go first (change in dead-bands x time waited x priority), the others wait for the next round
+    with a higher score. Instances draw from the bucket first come, first served.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+/* packets per second for all the sources of all the instances in this process. sender threads only, never the audio thread */
+class PacketBudget
+{
+    public:
+
+        static PacketBudget& getInstance()
+        {
+            static PacketBudget instance;
+            return instance;
+        }
+
+        /* bursts up to burstMs worth of packets */
+        void setRate(double packetsPerSecond) noexcept { rate.store(juce::jmax(1.0, packetsPerSecond)); }
+        double getRate() const noexcept { return rate.load(); }
+
+        /* up to wanted packets, from a bucket refilled with the time elapsed since the last call (of any instance) */
+        int take(int wanted, double nowMs) noexcept
+        {
+            const juce::SpinLock::ScopedLockType lock(mutex);
+            const auto packetsPerSecond = rate.load();
+            const auto burst = juce::jmax(1.0, packetsPerSecond * burstMs * 0.001);
+
+            // full bucket on the first call
+            tokens = lastRefillMs > 0.0 ? juce::jmin(burst, tokens + packetsPerSecond * juce::jmax(0.0, nowMs - lastRefillMs) * 0.001) : burst;
+            lastRefillMs = juce::jmax(lastRefillMs, nowMs);
+
+            const auto granted = juce::jlimit(0, wanted, (int)tokens);
+            tokens -= granted;
+            return granted;
+        }
+
+        /* packets taken but not sent */
+        void giveBack(int unused) noexcept
+        {
+            const juce::SpinLock::ScopedLockType lock(mutex);
+            tokens += unused;
+        }
+
+    private:
+
+        PacketBudget() = default;
+
+        static constexpr double burstMs = 20.0;
+
+        std::atomic<double> rate { 4000.0 };
+        juce::SpinLock mutex;
+        double tokens = 0.0;
+        double lastRefillMs = 0.0;
+};
+
+template <int maxSources>
+class SendScheduler
+{
+    public:
+
+        SendScheduler() { priorities.fill(1.0f); }
+
+        /* per source rate cap, also the rate of the rounds */
+        void setMaxRate(double hz) noexcept { minIntervalMs = 1000.0 / juce::jlimit(1.0, 1000.0, hz); }
+        double getRoundIntervalMs() const noexcept { return minIntervalMs; }
+
+        /* relative weight when the budget is short, 1 by default */
+        void setPriority(int slot, float priority) noexcept { priorities[(size_t)slot] = juce::jmax(0.0f, priority); }
+
+        /* once per round, before considering the sources */
+        void beginRound() noexcept { numCandidates = 0; }
+
+        /* urgency: change since the source was last sent, in dead-bands (>= 1 when it has to be sent) */
+        void consider(int slot, float urgency, double msSinceSent) noexcept
+        {
+            if (urgency < 1.0f || msSinceSent < minIntervalMs || numCandidates == maxSources)
+                return;
+
+            // sources waiting for several rounds because of the budget climb up the list.
+            // never sent: msSinceSent is huge, kept finite so that a priority of 0 gives a score of 0, not NaN
+            const auto waited = (float)juce::jmin(msSinceSent / minIntervalMs, maxRoundsWaited);
+            candidates[(size_t)numCandidates++] = { slot, priorities[(size_t)slot] * urgency * waited };
+        }
+
+        /* calls send(slot) for the due sources, most urgent first, within the process budget. send returns false when nothing went out */
+        template <typename SendFunction>
+        void sendDue(double nowMs, SendFunction&& send)
+        {
+            if (numCandidates == 0)
+                return;
+
+            const auto end = candidates.begin() + numCandidates;
+            std::sort(candidates.begin(), end, [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+            auto& budget = PacketBudget::getInstance();
+            auto granted = budget.take(numCandidates, nowMs);
+
+            for (auto it = candidates.begin(); it != end && granted > 0; ++it)
+                if (send(it->slot))
+                    --granted;
+
+            if (granted > 0)
+                budget.giveBack(granted);
+        }
+
+    private:
+
+        struct Candidate
+        {
+            int slot = 0;
+            float score = 0.0f;
+        };
+
+        static constexpr double maxRoundsWaited = 1.0e6;
+
+        double minIntervalMs = 2.0;     // 500 Hz
+
+        std::array<float, maxSources> priorities;
+        std::array<Candidate, maxSources> candidates;
+        int numCandidates = 0;
+};
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    SeqLock.h
+    Created: 18 Oct 2026 11:03:40am
+    @Author:  regnier
+    @Brief: Single writer / multiple reader sequence lock for small trivially copyable structs.
+    The writer never blocks (audio thread), readers retry if they raced a write.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+template <typename T>
+class SeqLock
+{
+    public:
+
+        static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+        /* single writer only */
+        void write(const T& value) noexcept
+        {
+            std::array<juce::uint32, numWords> words {};
+            std::memcpy(words.data(), &value, sizeof(T));
+
+            const auto seq = sequence.load(std::memory_order_relaxed);
+            sequence.store(seq + 1, std::memory_order_relaxed); // odd: write in progress
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (size_t i = 0; i < numWords; ++i)
+                data[i].store(words[i], std::memory_order_relaxed);
+
+            sequence.store(seq + 2, std::memory_order_release);
+        }
+
+        /* returns false if nothing was ever written, or if the writer kept interfering */
+        bool read(T& value) const noexcept
+        {
+            for (int attempt = 0; attempt < maxReadAttempts; ++attempt)
+            {
+                const auto seq = sequence.load(std::memory_order_acquire);
+
+                if (seq == 0)
+                    return false;
+
+                if ((seq & 1) != 0)
+                    continue;
+
+                std::array<juce::uint32, numWords> words;
+                for (size_t i = 0; i < numWords; ++i)
+                    words[i] = data[i].load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (sequence.load(std::memory_order_relaxed) == seq)
+                {
+                    std::memcpy(&value, words.data(), sizeof(T));
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+
+        static constexpr size_t numWords = (sizeof(T) + sizeof(juce::uint32) - 1) / sizeof(juce::uint32);
+        static constexpr int maxReadAttempts = 16;
+
+        std::atomic<juce::uint32> sequence { 0 };
+        std::array<std::atomic<juce::uint32>, numWords> data {};
+};
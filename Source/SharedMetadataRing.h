@@ -0,0 +1,431 @@
+/*
+  ==============================================================================
+
+    SharedMetadataRing.h
+    Created: 23 Oct 2026 10:14:40am
+    @Author:  regnier
+    @Brief: Shared memory transport for the source metadata, for a renderer / MAX bridge on the same machine.
+    A named shared memory object (shm_open on Linux / macOS, a named file mapping on Windows) holds a header and
+    a ring of fixed size records, each one carrying the fields of /iosono/renderer/version1/src in the same order.
+    One writer (the OSC thread) appends, any number of readers follow at their own pace:
+    --> each record has a sequence number, odd while it is being written, so a reader detects torn records
+    --> the header write count tells a reader how far behind it is, records it was lapped on are reported as lost
+    --> the header holds the id of the writer's process: a second writer is refused while that process is alive
+    --> an existing object is never resized, only a new one is sized: a ring left over by a crashed writer keeps its capacity
+    Readers work straight on the mapped memory: one record copy, no system call per record.
+    No JUCE here, so that a bridge process can just include this file.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+namespace SharedMetadataRing
+{
+    static constexpr std::uint32_t kMagic = 0x494f534d;  // "IOSM"
+    static constexpr std::uint32_t kVersion = 2;
+    static constexpr std::uint32_t kDefaultCapacity = 4096; // records, a power of two: 1 s at the default packet budget
+
+    /* /iosono/renderer/version1/src #source_index #source_type #azim #elev #dist #volume 0. 0. 0 0 0. 0,
+       same field types and order as the OSC message */
+    struct SourceFields
+    {
+        std::int32_t index;
+        std::int32_t type;
+        float azimuth;      // IOSONO convention, degrees
+        float elevation;    // degrees
+        float distance;     // meters
+        float volume;       // linear
+        float reserved0;
+        float reserved1;
+        std::int32_t reserved2;
+        std::int32_t reserved3;
+        float reserved4;
+        std::int32_t reserved5;
+    };
+
+    /* one cache line */
+    struct alignas(64) Record
+    {
+        std::atomic<std::uint64_t> sequence;   // 2 n + 1 while record n is written, 2 n + 2 once it is complete
+        double timeMs;                          // OSC time tag, ms since 1970, 0: immediately
+        SourceFields fields;
+    };
+
+    struct alignas(64) Header
+    {
+        std::atomic<std::uint32_t> magic;       // kMagic once initialised, 0 once the writer closed it
+        std::uint32_t version;
+        std::uint32_t capacity;                 // number of records
+        std::uint32_t recordSize;               // sizeof(Record), checked by the readers
+        std::atomic<std::uint64_t> writeCount;  // records written since the ring was created
+        std::atomic<std::uint32_t> ownerProcess; // process id of the writer, 0 when none
+    };
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free, "the ring is shared between processes");
+    static_assert(sizeof(Record) == 64, "record layout is part of the protocol");
+    static_assert(sizeof(Header) == 64, "header layout is part of the protocol");
+
+    inline std::size_t sizeForCapacity(std::uint32_t capacity) { return sizeof(Header) + (std::size_t)capacity * sizeof(Record); }
+
+    inline std::uint32_t currentProcessId()
+    {
+       #if defined(_WIN32)
+        return (std::uint32_t)GetCurrentProcessId();
+       #else
+        return (std::uint32_t)getpid();
+       #endif
+    }
+
+    /* false once the process has exited (a writer that crashed) */
+    inline bool isProcessAlive(std::uint32_t id)
+    {
+       #if defined(_WIN32)
+        auto process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)id);
+
+        if (process == nullptr)
+            return GetLastError() == ERROR_ACCESS_DENIED;
+
+        const auto running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+        CloseHandle(process);
+        return running;
+       #else
+        return kill((pid_t)id, 0) == 0 || errno == EPERM;
+       #endif
+    }
+
+    /* the shared memory object itself. the writer creates it (and removes the name when destroyed), readers open it */
+    class Mapping
+    {
+        public:
+
+            Mapping() = default;
+            ~Mapping() { close(); }
+
+            Mapping(const Mapping&) = delete;
+            Mapping& operator=(const Mapping&) = delete;
+
+            /* name without any leading slash, e.g. "iosono-metadata-1".
+               false if a writer that is still running (in this process or another one) has the name.
+               a ring left over by a writer that crashed is taken over with its own capacity */
+            bool create(const std::string& name, std::uint32_t capacity = kDefaultCapacity)
+            {
+                close();
+
+                // power of two, so that the slot is a mask
+                std::uint32_t roundedCapacity = 1;
+                while (roundedCapacity < capacity)
+                    roundedCapacity <<= 1;
+
+                // an existing object is mapped as it is: map() only sizes a new one
+                if (! map(name, sizeForCapacity(roundedCapacity), true))
+                    return false;
+
+                auto* header = getHeader();
+                const auto self = currentProcessId();
+                auto previousOwner = header->ownerProcess.load(std::memory_order_acquire);
+
+                // never write over a live ring. the claim is atomic, so that only one of two writers created at once gets it
+                if ((previousOwner != 0 && isProcessAlive(previousOwner))
+                    || ! header->ownerProcess.compare_exchange_strong(previousOwner, self, std::memory_order_acq_rel))
+                {
+                    close(); // not the owner: the name stays
+                    return false;
+                }
+
+                owner = true;
+
+                // left over by a writer that crashed: carry on counting, so that its readers keep up
+                if (header->magic.load(std::memory_order_acquire) == kMagic && header->version == kVersion
+                    && header->recordSize == sizeof(Record) && size >= sizeForCapacity(header->capacity))
+                    return true;
+
+                // the largest ring the object holds, at most the one asked for
+                auto usedCapacity = roundedCapacity;
+                while (usedCapacity > 0 && sizeForCapacity(usedCapacity) > size)
+                    usedCapacity >>= 1;
+
+                // a dead writer's object too small for a single record: it is ours now, remove it and start again
+                if (usedCapacity == 0)
+                {
+                    close();
+                    return create(name, capacity);
+                }
+
+                header->magic.store(0, std::memory_order_relaxed);
+                header->version = kVersion;
+                header->capacity = usedCapacity;
+                header->recordSize = (std::uint32_t)sizeof(Record);
+                header->writeCount.store(0, std::memory_order_relaxed);
+
+                for (std::uint32_t i = 0; i < usedCapacity; ++i)
+                    getRecords()[i].sequence.store(0, std::memory_order_relaxed);
+
+                // readers only accept the ring once the magic is there, written last
+                header->magic.store(kMagic, std::memory_order_release);
+                return true;
+            }
+
+            /* false when there is no such ring (yet) or it is not compatible */
+            bool open(const std::string& name)
+            {
+                close();
+
+                if (! map(name, 0, false))
+                    return false;
+
+                const auto* header = getHeader();
+
+                if (header->magic.load(std::memory_order_acquire) != kMagic || header->version != kVersion
+                    || header->recordSize != sizeof(Record) || size < sizeForCapacity(header->capacity))
+                {
+                    close();
+                    return false;
+                }
+
+                return true;
+            }
+
+            void close()
+            {
+                if (base == nullptr)
+                    return;
+
+                // tell the readers, which keep their mapping of the removed object
+                if (owner)
+                {
+                    getHeader()->magic.store(0, std::memory_order_release);
+                    getHeader()->ownerProcess.store(0, std::memory_order_release);
+                }
+
+               #if defined(_WIN32)
+                UnmapViewOfFile(base);
+                CloseHandle(handle);
+                handle = nullptr;
+               #else
+                munmap(base, size);
+
+                if (owner)
+                    shm_unlink(("/" + mappedName).c_str());
+               #endif
+
+                base = nullptr;
+                size = 0;
+                owner = false;
+            }
+
+            bool isOpen() const noexcept { return base != nullptr; }
+
+            Header* getHeader() const noexcept { return static_cast<Header*>(base); }
+            Record* getRecords() const noexcept { return reinterpret_cast<Record*>(static_cast<char*>(base) + sizeof(Header)); }
+
+        private:
+
+            /* createIt: requestedSize is only used when the object does not exist yet. an existing one may be
+               mapped by a live writer, resizing it would pull the pages from under that writer (SIGBUS) */
+            bool map(const std::string& name, std::size_t requestedSize, bool createIt)
+            {
+                mappedName = name;
+
+               #if defined(_WIN32)
+                const auto objectName = "Local\\" + name;
+
+                if (createIt)
+                    handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                                (DWORD)((std::uint64_t)requestedSize >> 32), (DWORD)(requestedSize & 0xffffffffu), objectName.c_str());
+                else
+                    handle = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, objectName.c_str());
+
+                if (handle == nullptr)
+                    return false;
+
+                const auto isNew = createIt && GetLastError() != ERROR_ALREADY_EXISTS;
+                base = MapViewOfFile(handle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, isNew ? requestedSize : 0);
+
+                if (base == nullptr)
+                {
+                    CloseHandle(handle);
+                    handle = nullptr;
+                    return false;
+                }
+
+                MEMORY_BASIC_INFORMATION info;
+                VirtualQuery(base, &info, sizeof(info));
+                size = isNew ? requestedSize : (std::size_t)info.RegionSize;
+                return true;
+               #else
+                const auto objectName = "/" + name;
+                int fd = createIt ? shm_open(objectName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666) : -1;
+                const auto isNew = fd >= 0;
+
+                if (! isNew)
+                    fd = shm_open(objectName.c_str(), O_RDWR, 0);
+
+                if (fd < 0)
+                    return false;
+
+                struct stat status;
+                const auto statFailed = fstat(fd, &status) != 0;
+
+                // macOS only sizes a shared memory object once anyway
+                if (statFailed || (isNew && ftruncate(fd, (off_t)requestedSize) != 0))
+                {
+                    ::close(fd);
+
+                    if (isNew)
+                        shm_unlink(objectName.c_str());
+
+                    return false;
+                }
+
+                // an existing object smaller than a header is being created by another writer right now
+                size = isNew ? requestedSize : (std::size_t)status.st_size;
+                base = size >= sizeof(Header) ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+                ::close(fd); // the mapping keeps the object alive
+
+                if (base == MAP_FAILED)
+                {
+                    base = nullptr;
+                    size = 0;
+                    return false;
+                }
+
+                return true;
+               #endif
+            }
+
+            void* base = nullptr;
+            std::size_t size = 0;
+            bool owner = false;
+            std::string mappedName;
+           #if defined(_WIN32)
+            HANDLE handle = nullptr;
+           #endif
+    };
+
+    /* single writer. no allocation, no system call */
+    class Writer
+    {
+        public:
+
+            bool create(const std::string& name, std::uint32_t capacity = kDefaultCapacity) { return mapping.create(name, capacity); }
+            void close() { mapping.close(); }
+            bool isOpen() const noexcept { return mapping.isOpen(); }
+
+            void write(const SourceFields& fields, double timeMs) noexcept
+            {
+                auto* header = mapping.getHeader();
+                const auto n = header->writeCount.load(std::memory_order_relaxed);
+                auto& record = mapping.getRecords()[n & (header->capacity - 1)];
+
+                record.sequence.store(2 * n + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);    // odd sequence visible before the fields change
+
+                record.timeMs = timeMs;
+                record.fields = fields;
+
+                record.sequence.store(2 * n + 2, std::memory_order_release);
+                header->writeCount.store(n + 1, std::memory_order_release);
+            }
+
+        private:
+
+            Mapping mapping;
+    };
+
+    /* any number of readers, each following the writer at its own pace */
+    class Reader
+    {
+        public:
+
+            /* starts at the current end of the ring: only records written from now on are read */
+            bool open(const std::string& name)
+            {
+                if (! mapping.open(name))
+                    return false;
+
+                readCount = mapping.getHeader()->writeCount.load(std::memory_order_acquire);
+                lost = 0;
+                return true;
+            }
+
+            void close() { mapping.close(); }
+            bool isOpen() const noexcept { return mapping.isOpen(); }
+
+            /* calls callback(double timeMs, const SourceFields&) for each new record, in order. returns the number
+               of records read. the record is copied out and checked again before the callback sees it: one the
+               writer started to overwrite meanwhile (this reader was a whole ring behind) is counted as lost instead */
+            template <typename Callback>
+            int poll(Callback&& callback, int maxRecords = 1 << 30)
+            {
+                const auto* header = mapping.getHeader();
+                const auto capacity = (std::uint64_t)header->capacity;
+                const auto writeCount = header->writeCount.load(std::memory_order_acquire);
+                int numRead = 0;
+
+                // lapped: the oldest records were overwritten already
+                if (writeCount - readCount > capacity)
+                {
+                    lost += writeCount - readCount - capacity;
+                    readCount = writeCount - capacity;
+                }
+
+                while (readCount < writeCount && numRead < maxRecords)
+                {
+                    const auto& record = mapping.getRecords()[readCount & (capacity - 1)];
+                    const auto expected = 2 * readCount + 2;
+
+                    if (record.sequence.load(std::memory_order_acquire) == expected)
+                    {
+                        const auto timeMs = record.timeMs;
+                        const auto fields = record.fields;
+
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (record.sequence.load(std::memory_order_relaxed) == expected)
+                            callback(timeMs, fields);
+                        else
+                            ++lost;
+                    }
+                    else
+                    {
+                        ++lost;
+                    }
+
+                    ++readCount;
+                    ++numRead;
+                }
+
+                return numRead;
+            }
+
+            /* records overwritten before this reader got to them, or torn while it read them */
+            std::uint64_t getLostCount() const noexcept { return lost; }
+
+            /* the writer went away (plugin removed, host closed): reopen to follow the next one */
+            bool isWriterClosed() const noexcept { return mapping.getHeader()->magic.load(std::memory_order_acquire) != kMagic; }
+
+        private:
+
+            Mapping mapping;
+            std::uint64_t readCount = 0;
+            std::uint64_t lost = 0;
+    };
+}
@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+    SourceRadar.cpp
+    Created: 27 Oct 2026 9:48:15am
+    @Author:  regnier
+
+  ==============================================================================
+*/
+
+#include "SourceRadar.h"
+#include "DistanceCues.h"
+
+SourceRadar::SourceRadar(SnapshotReader reader)
+    : readSnapshot(std::move(reader))
+{
+    // the background image covers everything: nothing behind needs repainting
+    setOpaque(true);
+}
+
+SourceRadar::~SourceRadar()
+{
+    stopTimer();
+}
+
+void SourceRadar::resized()
+{
+    // two square views side by side
+    auto area = getLocalBounds().toFloat().reduced(4.0f);
+    const auto size = juce::jmax(0.0f, juce::jmin(area.getHeight() - 14.0f, (area.getWidth() - 8.0f) * 0.5f));
+
+    topView = area.removeFromLeft(area.getWidth() * 0.5f).withSizeKeepingCentre(size, size).translated(0.0f, 7.0f);
+    sideView = area.withSizeKeepingCentre(size, size).translated(0.0f, 7.0f);
+
+    renderBackground();
+
+    // markers at the new scale at the next frame
+    numShown = 0;
+    repaint();
+}
+
+void SourceRadar::visibilityChanged()     { updateTimer(); }
+void SourceRadar::parentHierarchyChanged() { updateTimer(); }
+
+void SourceRadar::updateTimer()
+{
+    if (isShowing())
+        startTimerHz(refreshRate);
+    else
+        stopTimer();
+}
+
+float SourceRadar::radiusFor(float distance) noexcept
+{
+    return std::sqrt(juce::jlimit(0.0f, 1.0f, distance / DistanceCues::kMaxDistance));
+}
+
+juce::Point<float> SourceRadar::toView(juce::Rectangle<float> view, float h, float v) noexcept
+{
+    const auto centre = view.getCentre();
+    const auto radius = view.getWidth() * 0.5f;
+    return { centre.x + h * radius, centre.y - v * radius };
+}
+
+void SourceRadar::renderBackground()
+{
+    if (getWidth() <= 0 || getHeight() <= 0)
+    {
+        background = {};
+        return;
+    }
+
+    // at the display scale, so that the cached rings are as sharp as drawn ones
+    backgroundScale = (float)juce::Component::getApproximateScaleFactorForComponent(this);
+    background = juce::Image(juce::Image::RGB, juce::roundToInt((float)getWidth() * backgroundScale),
+                             juce::roundToInt((float)getHeight() * backgroundScale), true);
+
+    juce::Graphics g(background);
+    g.addTransform(juce::AffineTransform::scale(backgroundScale));
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+    const std::array<std::pair<juce::Rectangle<float>, const char*>, 2> views { { { topView, "top" }, { sideView, "side" } } };
+    const float rings[] = { 1.0f, 10.0f, 30.0f, 100.0f, 300.0f };
+
+    for (const auto& view : views)
+    {
+        const auto& area = view.first;
+        const auto centre = area.getCentre();
+
+        g.setColour(juce::Colours::azure.withAlpha(0.25f));
+        g.drawLine(area.getX(), centre.y, area.getRight(), centre.y);
+        g.drawLine(centre.x, area.getY(), centre.x, area.getBottom());
+
+        g.setFont(9.0f);
+
+        for (auto distance : rings)
+        {
+            const auto radius = radiusFor(distance) * area.getWidth() * 0.5f;
+            g.setColour(juce::Colours::azure.withAlpha(0.4f));
+            g.drawEllipse(centre.x - radius, centre.y - radius, 2.0f * radius, 2.0f * radius, 1.0f);
+            g.setColour(juce::Colours::azure.withAlpha(0.6f));
+            g.drawText(juce::String((int)distance) + "m", juce::Rectangle<float>(centre.x + 2.0f, centre.y - radius, 30.0f, 10.0f),
+                       juce::Justification::topLeft, false);
+        }
+
+        // the listener
+        g.setColour(juce::Colours::white);
+        g.fillEllipse(centre.x - 2.5f, centre.y - 2.5f, 5.0f, 5.0f);
+
+        g.setFont(12.0f);
+        g.drawText(view.second, area.withHeight(14.0f).translated(0.0f, -16.0f), juce::Justification::centred, false);
+    }
+
+    g.setFont(9.0f);
+    g.setColour(juce::Colours::azure.withAlpha(0.6f));
+    g.drawText("front", topView.withHeight(10.0f), juce::Justification::centredTop, false);
+    g.drawText("front", sideView.withTrimmedLeft(sideView.getWidth() - 30.0f).withSizeKeepingCentre(30.0f, 10.0f), juce::Justification::centredRight, false);
+    g.drawText("up", sideView.withHeight(10.0f), juce::Justification::centredTop, false);
+}
+
+void SourceRadar::markerBounds(const SourceMetadata& source, juce::Rectangle<int>& top, juce::Rectangle<int>& side) const noexcept
+{
+    // IOSONO azimuth: 0 deg to the right, anticlockwise, so front is +90 deg
+    const auto azimuth = juce::degreesToRadians(source.azimuth);
+    const auto elevation = juce::degreesToRadians(source.elevation);
+    const auto radius = radiusFor(source.distance);
+
+    const auto right = radius * std::cos(elevation) * std::cos(azimuth);
+    const auto front = radius * std::cos(elevation) * std::sin(azimuth);
+    const auto up = radius * std::sin(elevation);
+
+    auto marker = [](juce::Point<float> centre)
+    {
+        return juce::Rectangle<int>(markerSize, markerSize).withCentre(centre.roundToInt());
+    };
+
+    top = marker(toView(topView, right, front));
+    side = marker(toView(sideView, front, up));
+}
+
+void SourceRadar::timerCallback()
+{
+    std::array<SourceMetadata, maxSources> latest;
+    const auto count = juce::jlimit(0, maxSources, readSnapshot != nullptr ? readSnapshot(latest.data(), maxSources) : 0);
+
+    // only the markers that moved by a pixel (or appeared / disappeared): their old and new bounds
+    juce::RectangleList<int> dirty;
+
+    for (int s = 0; s < juce::jmax(count, numShown); ++s)
+    {
+        juce::Rectangle<int> top, side;
+
+        if (s < count)
+            markerBounds(latest[(size_t)s], top, side);
+
+        const auto volume = s < count ? latest[(size_t)s].volume : 0.0f;
+        const auto index = s < count ? latest[(size_t)s].index : 0;
+        const auto changed = s >= numShown || top != topBounds[(size_t)s] || side != sideBounds[(size_t)s]
+                          || index != shownIndex[(size_t)s] || std::abs(volume - shownVolume[(size_t)s]) > 0.02f;
+
+        if (! changed)
+            continue;
+
+        if (s < numShown)
+        {
+            dirty.add(topBounds[(size_t)s]);
+            dirty.add(sideBounds[(size_t)s]);
+        }
+
+        dirty.add(top);
+        dirty.add(side);
+
+        topBounds[(size_t)s] = top;
+        sideBounds[(size_t)s] = side;
+        shownIndex[(size_t)s] = index;
+        shownVolume[(size_t)s] = volume;
+    }
+
+    numShown = count;
+
+    for (const auto& area : dirty)
+        if (! area.isEmpty())
+            repaint(area);
+}
+
+void SourceRadar::paint(juce::Graphics& g)
+{
+    if (background.isValid())
+        g.drawImageTransformed(background, juce::AffineTransform::scale(1.0f / backgroundScale));
+    else
+        g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+    const auto clip = g.getClipBounds();
+    g.setFont(9.0f);
+
+    for (int s = 0; s < numShown; ++s)
+    {
+        // brighter when louder
+        const auto colour = juce::Colours::orange.withAlpha(0.35f + 0.65f * juce::jlimit(0.0f, 1.0f, shownVolume[(size_t)s]));
+
+        for (const auto& bounds : { topBounds[(size_t)s], sideBounds[(size_t)s] })
+        {
+            if (! bounds.intersects(clip))
+                continue;
+
+            g.setColour(colour);
+            g.fillEllipse(bounds.toFloat().reduced(1.0f));
+            g.setColour(juce::Colours::black);
+            g.drawText(juce::String(shownIndex[(size_t)s]), bounds, juce::Justification::centred, false);
+        }
+    }
+}
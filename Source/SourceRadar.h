@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    SourceRadar.h
+    Created: 27 Oct 2026 9:48:15am
+    @Author:  regnier
+    @Brief: Where the sources are: top view (right / front) and side view (front / up), with distance rings.
+    Refreshed at 60 fps from a lock-free snapshot of the metadata (never from the APVTS), and kept cheap for the
+    message thread when many editors are open:
+    --> rings, axes and labels are drawn once per size into a cached juce::Image
+    --> a frame only repaints the old and new bounds of the markers that moved by a pixel (or changed level), nothing otherwise
+    --> the timer only runs while the component is showing
+    The distance scale is a square root (like the DIST slider), so that close sources are not all on the centre.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "MetadataSender.h"
+
+class SourceRadar : public juce::Component,
+                    private juce::Timer
+{
+    public:
+
+        static constexpr int maxSources = MetadataSender::maxSources;
+
+        /* copies the latest state of up to maxSources sources, returns how many. message thread, every frame: must not block */
+        using SnapshotReader = std::function<int(SourceMetadata* sources, int maxSources)>;
+
+        explicit SourceRadar(SnapshotReader reader);
+        ~SourceRadar() override;
+
+        void paint(juce::Graphics& g) override;
+        void resized() override;
+        void visibilityChanged() override;
+        void parentHierarchyChanged() override;
+
+    private:
+
+        void timerCallback() override;
+        void updateTimer();
+        void renderBackground();
+
+        /* position in a view, h / v in [-1, 1] (right / front for the top view, front / up for the side view) */
+        static juce::Point<float> toView(juce::Rectangle<float> view, float h, float v) noexcept;
+        /* fraction of the view radius for a distance */
+        static float radiusFor(float distance) noexcept;
+        void markerBounds(const SourceMetadata& source, juce::Rectangle<int>& top, juce::Rectangle<int>& side) const noexcept;
+
+        static constexpr int refreshRate = 60;
+        static constexpr int markerSize = 14;
+
+        SnapshotReader readSnapshot;
+
+        juce::Image background;         // both views without the sources, at the display scale
+        float backgroundScale = 1.0f;
+        juce::Rectangle<float> topView, sideView;
+
+        /* what was last painted */
+        std::array<int, maxSources> shownIndex {};
+        std::array<float, maxSources> shownVolume {};
+        std::array<juce::Rectangle<int>, maxSources> topBounds, sideBounds;
+        int numShown = 0;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SourceRadar)
+};
@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    Trajectory.cpp
+    Created: 22 Oct 2026 9:31:54am
+    @Author:  regnier
+
+  ==============================================================================
+*/
+
+#include "Trajectory.h"
+
+float Trajectory::State::azimuth() const noexcept
+{
+    auto degrees = juce::radiansToDegrees(std::atan2(position.x, position.y));
+    if (degrees < 0.0) degrees += 360.0; // wrap around
+    return (float)degrees;
+}
+
+float Trajectory::State::elevation() const noexcept
+{
+    return (float)juce::radiansToDegrees(std::atan2(position.z, std::sqrt(position.x * position.x + position.y * position.y)));
+}
+
+std::unique_ptr<Trajectory> Trajectory::linear(Vector start, Vector velocity)
+{
+    std::unique_ptr<Trajectory> trajectory(new Trajectory());
+    trajectory->type = Type::linear;
+    trajectory->origin = start;
+    trajectory->direction = velocity;
+    return trajectory;
+}
+
+std::unique_ptr<Trajectory> Trajectory::orbit(Vector centre, double radius, double periodSeconds, double startAzimuth)
+{
+    jassert(periodSeconds != 0.0);
+
+    std::unique_ptr<Trajectory> trajectory(new Trajectory());
+    trajectory->type = Type::orbit;
+    trajectory->origin = centre;
+    trajectory->radius = std::abs(radius);
+    trajectory->phase = juce::degreesToRadians(startAzimuth);
+    trajectory->angularSpeed = periodSeconds != 0.0 ? juce::MathConstants<double>::twoPi / periodSeconds : 0.0;
+    return trajectory;
+}
+
+std::unique_ptr<Trajectory> Trajectory::spline(std::vector<Keyframe> keyframes, bool loop)
+{
+    jassert(! keyframes.empty());
+
+    std::stable_sort(keyframes.begin(), keyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+
+    std::unique_ptr<Trajectory> trajectory(new Trajectory());
+    trajectory->type = Type::spline;
+
+    const auto numKeyframes = (int)keyframes.size();
+    const auto period = numKeyframes > 1 ? keyframes.back().time - keyframes.front().time : 0.0;
+    trajectory->looping = loop && period > 0.0;
+
+    for (auto& keyframe : keyframes)
+    {
+        trajectory->times.push_back(keyframe.time);
+        trajectory->points.push_back(keyframe.position);
+    }
+
+    // Catmull-Rom tangents for non uniform times: (next - previous) / (next time - previous time).
+    // the ends use a one sided difference, or wrap around when looping (last keyframe = first one)
+    for (int i = 0; i < numKeyframes; ++i)
+    {
+        auto previous = juce::jmax(0, i - 1);
+        auto next = juce::jmin(numKeyframes - 1, i + 1);
+        auto previousTime = keyframes[(size_t)previous].time;
+        auto nextTime = keyframes[(size_t)next].time;
+
+        if (trajectory->looping && numKeyframes > 2 && (i == 0 || i == numKeyframes - 1))
+        {
+            previous = numKeyframes - 2;
+            next = 1;
+            previousTime = keyframes[(size_t)previous].time - (i == 0 ? period : 0.0);
+            nextTime = keyframes[(size_t)next].time + (i == 0 ? 0.0 : period);
+        }
+
+        const auto interval = nextTime - previousTime;
+        trajectory->tangents.push_back(interval > 0.0 ? (keyframes[(size_t)next].position - keyframes[(size_t)previous].position) * (1.0 / interval)
+                                                      : Vector());
+    }
+
+    return trajectory;
+}
+
+Trajectory::State Trajectory::withDistance(Vector position, Vector velocity) noexcept
+{
+    State state;
+    state.position = position;
+    state.velocity = velocity;
+    state.distance = position.length();
+
+    // d|p|/dt = p.v / |p|, undefined at the listener position
+    state.radialVelocity = state.distance > 1.0e-9 ? position.dot(velocity) / state.distance : 0.0;
+    return state;
+}
+
+Trajectory::State Trajectory::evaluate(double t) const noexcept
+{
+    switch (type)
+    {
+        case Type::orbit:
+        {
+            // azimuth convention: 0 in front, clockwise, i.e. x = sin, y = cos
+            const auto angle = phase + angularSpeed * t;
+            const auto sine = std::sin(angle);
+            const auto cosine = std::cos(angle);
+
+            return withDistance(origin + Vector { radius * sine, radius * cosine, 0.0 },
+                                Vector { radius * angularSpeed * cosine, -radius * angularSpeed * sine, 0.0 });
+        }
+
+        case Type::spline:
+            return evaluateSpline(t);
+
+        case Type::linear:
+        default:
+            return withDistance(origin + direction * t, direction);
+    }
+}
+
+Trajectory::State Trajectory::evaluateSpline(double t) const noexcept
+{
+    const auto numKeyframes = (int)times.size();
+
+    if (looping)
+    {
+        const auto period = times.back() - times.front();
+        const auto elapsed = t - times.front();
+        t = times.front() + elapsed - period * std::floor(elapsed / period);
+    }
+
+    if (numKeyframes == 1 || t < times.front())
+        return withDistance(points.front(), Vector());
+
+    if (t >= times.back())
+        return withDistance(points.back(), Vector());
+
+    // segment [i, i + 1] containing t, binary search
+    const auto i = (int)(std::upper_bound(times.begin(), times.end(), t) - times.begin()) - 1;
+    const auto interval = times[(size_t)i + 1] - times[(size_t)i];
+
+    if (interval <= 0.0)
+        return withDistance(points[(size_t)i + 1], Vector());
+
+    // cubic Hermite, position and its analytic derivative
+    const auto s = (t - times[(size_t)i]) / interval;
+    const auto s2 = s * s;
+    const auto s3 = s2 * s;
+
+    const auto& p0 = points[(size_t)i];
+    const auto& p1 = points[(size_t)i + 1];
+    const auto m0 = tangents[(size_t)i] * interval;
+    const auto m1 = tangents[(size_t)i + 1] * interval;
+
+    const auto position = p0 * (2.0 * s3 - 3.0 * s2 + 1.0) + m0 * (s3 - 2.0 * s2 + s) + p1 * (3.0 * s2 - 2.0 * s3) + m1 * (s3 - s2);
+    const auto velocity = (p0 * (6.0 * s2 - 6.0 * s) + m0 * (3.0 * s2 - 4.0 * s + 1.0) + p1 * (6.0 * s - 6.0 * s2) + m1 * (3.0 * s2 - 2.0 * s))
+                          * (1.0 / interval);
+
+    return withDistance(position, velocity);
+}
+
+Trajectory::Propagation Trajectory::propagationAt(double t) const noexcept
+{
+    static constexpr double speedOfSound = 1.0 / (double)DistanceCues::kSecondsPerMeter;
+
+    // Newton on f(delay) = delay - r(t - delay) / c, f' = 1 + r'(t - delay) / c, from the delay of the current position.
+    // the first guess is off by about delay * v / c, 3 iterations bring it to rounding level below Mach 0.5
+    Propagation propagation;
+    propagation.emission = evaluate(t);
+    propagation.delay = propagation.emission.distance / speedOfSound;
+
+    for (int iteration = 0; iteration < 3; ++iteration)
+    {
+        propagation.emission = evaluate(t - propagation.delay);
+        const auto slope = juce::jmax(0.1, 1.0 + propagation.emission.radialVelocity / speedOfSound);
+        propagation.delay -= (propagation.delay - propagation.emission.distance / speedOfSound) / slope;
+    }
+
+    propagation.emission = evaluate(t - propagation.delay);
+
+    // delay = r(t - delay) / c  -->  delay' = r' (1 - delay') / c  -->  delay' = r' / (c + r').
+    // the radial velocity is limited to +-Mach 0.9 so that the rate stays finite
+    const auto radialVelocity = juce::jlimit(-0.9 * speedOfSound, 0.9 * speedOfSound, propagation.emission.radialVelocity);
+    propagation.delayRate = radialVelocity / (speedOfSound + radialVelocity);
+    return propagation;
+}
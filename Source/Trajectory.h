@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    Trajectory.h
+    Created: 22 Oct 2026 9:31:54am
+    @Author:  regnier
+    @Brief: Parametric source paths: linear, circular orbit, spline through keyframes.
+    Position and velocity are evaluated analytically at any time, so the audio thread gets the exact
+    propagation delay and its rate of change (from the radial velocity) once per block, instead of
+    chasing the DIST parameter with a smoother.
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "DistanceCues.h"
+
+class Trajectory
+{
+    public:
+
+        /* listener at the origin, meters: x to the right, y to the front, z up */
+        struct Vector
+        {
+            double x = 0.0, y = 0.0, z = 0.0;
+
+            Vector operator+ (const Vector& other) const noexcept { return { x + other.x, y + other.y, z + other.z }; }
+            Vector operator- (const Vector& other) const noexcept { return { x - other.x, y - other.y, z - other.z }; }
+            Vector operator* (double scale) const noexcept        { return { x * scale, y * scale, z * scale }; }
+
+            double dot(const Vector& other) const noexcept { return x * other.x + y * other.y + z * other.z; }
+            double length() const noexcept { return std::sqrt(dot(*this)); }
+        };
+
+        struct State
+        {
+            Vector position;
+            Vector velocity;                // m/s
+            double distance = 0.0;          // m
+            double radialVelocity = 0.0;    // m/s, positive when moving away
+
+            /* usual conventions, same as the AZIM / ELEV parameters: 0 deg in front, clockwise */
+            float azimuth() const noexcept;
+            float elevation() const noexcept;
+        };
+
+        /* what is heard at a given time: it left the source delay seconds earlier, from emission */
+        struct Propagation
+        {
+            double delay = 0.0;             // s
+            double delayRate = 0.0;         // d delay / dt, -v/c approaching, +v/c receding
+            State emission;
+        };
+
+        struct Keyframe
+        {
+            double time = 0.0;              // s
+            Vector position;
+        };
+
+        /* start + velocity * t */
+        static std::unique_ptr<Trajectory> linear(Vector start, Vector velocity);
+
+        /* horizontal circle around centre, one turn per periodSeconds, clockwise seen from above (negative period: anticlockwise) */
+        static std::unique_ptr<Trajectory> orbit(Vector centre, double radius, double periodSeconds, double startAzimuth = 0.0);
+
+        /* Catmull-Rom spline through the keyframes (sorted by time here), holding the first / last one outside their range.
+           with loop, the path repeats with period last - first time, and the last keyframe should be the same point as the first */
+        static std::unique_ptr<Trajectory> spline(std::vector<Keyframe> keyframes, bool loop);
+
+        /* position and velocity t seconds after the start of the trajectory. allocation free, audio thread */
+        State evaluate(double t) const noexcept;
+
+        /* propagation to the listener at time t: solves delay = distance(t - delay) / c (Newton),
+           for sources moving well below the speed of sound */
+        Propagation propagationAt(double t) const noexcept;
+
+    private:
+
+        enum class Type { linear, orbit, spline };
+
+        Trajectory() = default;
+
+        State evaluateSpline(double t) const noexcept;
+        static State withDistance(Vector position, Vector velocity) noexcept;
+
+        Type type = Type::linear;
+
+        /* linear: origin + direction * t. orbit: centre, radius, phase (rad), angular speed (rad/s) */
+        Vector origin;
+        Vector direction;
+        double radius = 0.0;
+        double phase = 0.0;
+        double angularSpeed = 0.0;
+
+        /* spline, tangents precomputed from the neighbouring keyframes */
+        std::vector<double> times;
+        std::vector<Vector> points;
+        std::vector<Vector> tangents;
+        bool looping = false;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Trajectory)
+};
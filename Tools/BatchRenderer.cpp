@@ -0,0 +1,337 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+    Created: 25 Oct 2026 9:12:47am
+    Author:  regnier
+    Brief: Offline renderer, to pre-render stems with the distance cues outside of a DAW.
+    Runs IOSONOSourceControlAudioProcessor headlessly on many files at once, one file per job on a thread pool
+    (one processor per job, nothing shared, so it scales with the cores). Each file follows a trajectory file
+    and gets the processed audio plus the metadata log of the render (MetadataLog.h, one record per block).
+    Processors run in non-realtime mode: no OSC, no live position input.
+
+    usage: IOSONOBatchRenderer [--jobs N] [--output dir] [--block 512] [--air] [--doppler] [--index 1]
+                               [--tail seconds] [--trajectory file] input.wav ...
+
+    trajectory: <input>.trajectory next to each input, or the --trajectory file for all of them. text, one keyframe per line:
+        time azimuth elevation distance     (seconds, degrees with the AZIM / ELEV conventions, meters)
+    a line "loop" repeats the path, # starts a comment. the keyframes are joined by a Catmull-Rom spline.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        int jobs = juce::SystemStats::getNumCpus();
+        int blockSize = 512;
+        bool air = false;
+        bool doppler = false;
+        int index = 1;
+        double tailSeconds = -1.0;  // default: 1 s with DOPPLER (longest delay of the DIST range), none without
+        juce::File trajectory;
+        juce::File outputDirectory = juce::File::getCurrentWorkingDirectory();
+        juce::Array<juce::File> inputs;
+    };
+
+    Options parseOptions(const juce::StringArray& args)
+    {
+        Options options;
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+
+        for (int i = 0; i < args.size(); ++i)
+        {
+            if (args[i] == "--jobs" && i + 1 < args.size())
+                options.jobs = juce::jmax(1, args[++i].getIntValue());
+            else if (args[i] == "--block" && i + 1 < args.size())
+                options.blockSize = juce::jlimit(16, 8192, args[++i].getIntValue());
+            else if (args[i] == "--air")
+                options.air = true;
+            else if (args[i] == "--doppler")
+                options.doppler = true;
+            else if (args[i] == "--index" && i + 1 < args.size())
+                options.index = juce::jlimit(1, 64, args[++i].getIntValue());
+            else if (args[i] == "--tail" && i + 1 < args.size())
+                options.tailSeconds = juce::jmax(0.0, args[++i].getDoubleValue());
+            else if (args[i] == "--trajectory" && i + 1 < args.size())
+                options.trajectory = cwd.getChildFile(args[++i]);
+            else if (args[i] == "--output" && i + 1 < args.size())
+                options.outputDirectory = cwd.getChildFile(args[++i]);
+            else
+                options.inputs.add(cwd.getChildFile(args[i]));
+        }
+
+        if (options.tailSeconds < 0.0)
+            options.tailSeconds = options.doppler ? 1.0 : 0.0;
+
+        return options;
+    }
+
+    /* keyframes in polar form, converted to the listener frame of Trajectory: x to the right, y to the front, z up */
+    std::unique_ptr<Trajectory> loadTrajectory(const juce::File& file, juce::String& error)
+    {
+        std::vector<Trajectory::Keyframe> keyframes;
+        bool loop = false;
+
+        for (auto line : juce::StringArray::fromLines(file.loadFileAsString()))
+        {
+            line = line.upToFirstOccurrenceOf("#", false, false).trim();
+
+            if (line.isEmpty())
+                continue;
+
+            if (line == "loop")
+            {
+                loop = true;
+                continue;
+            }
+
+            const auto tokens = juce::StringArray::fromTokens(line, false);
+
+            if (tokens.size() != 4)
+            {
+                error = file.getFileName() + ": expected time azimuth elevation distance, got \"" + line + "\"";
+                return nullptr;
+            }
+
+            const auto azimuth = juce::degreesToRadians(tokens[1].getDoubleValue());
+            const auto elevation = juce::degreesToRadians(tokens[2].getDoubleValue());
+            const auto distance = tokens[3].getDoubleValue();
+
+            Trajectory::Keyframe keyframe;
+            keyframe.time = tokens[0].getDoubleValue();
+            keyframe.position = { distance * std::cos(elevation) * std::sin(azimuth),
+                                  distance * std::cos(elevation) * std::cos(azimuth),
+                                  distance * std::sin(elevation) };
+            keyframes.push_back(keyframe);
+        }
+
+        if (keyframes.empty())
+        {
+            error = file.getFileName() + ": no keyframes";
+            return nullptr;
+        }
+
+        return Trajectory::spline(std::move(keyframes), loop);
+    }
+
+    void setParameter(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = apvts.getParameter(parameterID))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    /* transport of the render: always playing, at the current sample */
+    class OfflinePlayHead : public juce::AudioPlayHead
+    {
+        public:
+
+            juce::Optional<PositionInfo> getPosition() const override
+            {
+                PositionInfo info;
+                info.setIsPlaying(true);
+                info.setTimeInSamples(samplePosition);
+                info.setTimeInSeconds((double)samplePosition / sampleRate);
+                return info;
+            }
+
+            double sampleRate = 48000.0;
+            juce::int64 samplePosition = 0;
+    };
+
+    struct Result
+    {
+        juce::String error;
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;
+    };
+
+    Result renderFile(const juce::File& input, const Options& options)
+    {
+        Result result;
+        const auto start = Clock::now();
+
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+
+        if (reader == nullptr)
+        {
+            result.error = input.getFileName() + ": cannot read";
+            return result;
+        }
+
+        // the processor takes the layout of the file: a mono file costs half a stereo one
+        const auto numChannels = (int)reader->numChannels;
+
+        const auto trajectoryFile = options.trajectory != juce::File() ? options.trajectory : input.withFileExtension("trajectory");
+        auto trajectory = loadTrajectory(trajectoryFile, result.error);
+
+        if (trajectory == nullptr)
+        {
+            if (result.error.isEmpty() || ! trajectoryFile.existsAsFile())
+                result.error = input.getFileName() + ": no trajectory (" + trajectoryFile.getFileName() + ")";
+
+            return result;
+        }
+
+        const auto outputFile = options.outputDirectory.getChildFile(input.getFileNameWithoutExtension() + ".wav");
+        const auto logFile = outputFile.withFileExtension("iosolog");
+
+        if (outputFile == input)
+        {
+            result.error = input.getFileName() + ": would overwrite the input, use --output";
+            return result;
+        }
+
+        outputFile.deleteFile();
+        auto stream = outputFile.createOutputStream();
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (stream != nullptr)
+            writer.reset(wav.createWriterFor(stream.get(), reader->sampleRate, (unsigned int)numChannels,
+                                             juce::jmax(24, (int)reader->bitsPerSample), {}, 0));
+
+        if (writer == nullptr)
+        {
+            result.error = outputFile.getFullPathName() + ": cannot write";
+            return result;
+        }
+
+        stream.release(); // owned by the writer now
+
+        MetadataLogWriter log;
+
+        if (! log.open(logFile))
+        {
+            result.error = logFile.getFullPathName() + ": cannot write";
+            return result;
+        }
+
+        // processor set up like a host would for a bounce
+        const auto sampleRate = reader->sampleRate;
+        const auto blockSize = options.blockSize;
+
+        IOSONOSourceControlAudioProcessor processor;
+        OfflinePlayHead playHead;
+        playHead.sampleRate = sampleRate;
+
+        setParameter(processor.apvts, "AIR", options.air ? 1.0f : 0.0f);
+        setParameter(processor.apvts, "DOPPLER", options.doppler ? 1.0f : 0.0f);
+        setParameter(processor.apvts, "INDEX", (float)options.index);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+
+        if (! processor.setBusesLayout(layout))
+        {
+            result.error = input.getFileName() + ": " + juce::String(numChannels) + " channels not supported";
+            return result;
+        }
+
+        processor.setNonRealtime(true);
+        processor.setPlayHead(&playHead);
+        processor.setTrajectory(std::move(trajectory));
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        const auto inputLength = (juce::int64)reader->lengthInSamples;
+        const auto totalLength = inputLength + (juce::int64)(options.tailSeconds * sampleRate);
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        for (juce::int64 position = 0; position < totalLength; position += blockSize)
+        {
+            const auto numSamples = (int)juce::jmin((juce::int64)blockSize, totalLength - position);
+            buffer.setSize(numChannels, numSamples, false, false, true);
+            buffer.clear();
+
+            // past the end of the file: silence, so that the doppler delay line empties
+            if (position < inputLength)
+                reader->read(&buffer, 0, (int)juce::jmin((juce::int64)numSamples, inputLength - position), position, true, true);
+
+            playHead.samplePosition = position;
+            processor.processBlock(buffer, midi);
+
+            writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+            log.append(processor.getCurrentMetadata(), (double)position / sampleRate);
+        }
+
+        processor.releaseResources();
+        processor.setPlayHead(nullptr);
+        log.close();
+        writer.reset();
+
+        result.audioSeconds = (double)totalLength / sampleRate;
+        result.renderSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    const auto options = parseOptions(args);
+
+    if (options.inputs.isEmpty())
+    {
+        std::cerr << "usage: IOSONOBatchRenderer [--jobs N] [--output dir] [--block 512] [--air] [--doppler] [--index 1]"
+                     " [--tail seconds] [--trajectory file] input.wav ..." << std::endl;
+        return 2;
+    }
+
+    if (! options.outputDirectory.createDirectory())
+    {
+        std::cerr << options.outputDirectory.getFullPathName() << ": cannot create" << std::endl;
+        return 1;
+    }
+
+    // one job per file, at most one per core by default: each job owns its processor and its files
+    juce::ThreadPool pool(juce::jmin(options.jobs, options.inputs.size()));
+    juce::CriticalSection outputLock;
+    std::atomic<int> numFailed { 0 };
+    double totalAudioSeconds = 0.0;
+    const auto start = Clock::now();
+
+    for (auto& input : options.inputs)
+    {
+        pool.addJob([&, input]
+            {
+                const auto result = renderFile(input, options);
+                const juce::ScopedLock sl(outputLock);
+
+                if (result.error.isNotEmpty())
+                {
+                    ++numFailed;
+                    std::cerr << result.error << std::endl;
+                    return;
+                }
+
+                totalAudioSeconds += result.audioSeconds;
+                std::cerr << input.getFileName() << ": " << result.audioSeconds << " s in " << result.renderSeconds << " s ("
+                          << result.audioSeconds / juce::jmax(1.0e-9, result.renderSeconds) << "x real time)" << std::endl;
+            });
+    }
+
+    while (pool.getNumJobs() > 0)
+        juce::Thread::sleep(20);
+
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cerr << options.inputs.size() - numFailed.load() << " files, " << totalAudioSeconds << " s of audio in " << elapsed << " s ("
+              << totalAudioSeconds / juce::jmax(1.0e-9, elapsed) << "x real time, " << pool.getNumThreads() << " jobs)" << std::endl;
+
+    return numFailed.load() == 0 ? 0 : 1;
+}
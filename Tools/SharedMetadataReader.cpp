@@ -0,0 +1,169 @@
+/*
+  ==============================================================================
+
+    SharedMetadataReader.cpp
+    Created: 23 Oct 2026 2:36:18pm
+    @Author:  regnier
+    @Brief: Reference reader for the shared memory metadata transport (Source/SharedMetadataRing.h),
+    the starting point for a local renderer / MAX bridge. Plain C++, no JUCE.
+    --> IOSONOSharedMemoryReader [--quiet] [name ...]           follows the rings (default iosono-metadata-1),
+                                                                prints each record like the OSC message, and a rate summary per second
+    --> IOSONOSharedMemoryReader --write [name] [rate]          writes a source orbiting at rate records per second (default 500),
+                                                                to test a reader without the plugin
+
+  ==============================================================================
+*/
+
+#include "../Source/SharedMetadataRing.h"
+
+#include <chrono>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double nowMs()
+{
+    using namespace std::chrono;
+    return (double)duration_cast<microseconds>(system_clock::now().time_since_epoch()).count() * 0.001;
+}
+
+static std::atomic<bool> stopRequested { false };
+
+static int runWriter(const std::string& name, double rate)
+{
+    SharedMetadataRing::Writer writer;
+
+    if (! writer.create(name))
+    {
+        std::fprintf(stderr, "cannot create %s (no shared memory, or another running writer has it)\n", name.c_str());
+        return 1;
+    }
+
+    std::printf("writing %s at %.0f records/s, ctrl-c to stop\n", name.c_str(), rate);
+
+    const auto interval = std::chrono::duration<double>(1.0 / rate);
+    auto next = std::chrono::steady_clock::now();
+
+    // ctrl-c closes the ring, so that the readers see the writer go
+    std::signal(SIGINT, [](int) { stopRequested.store(true); });
+    std::signal(SIGTERM, [](int) { stopRequested.store(true); });
+
+    for (std::uint64_t n = 0; ! stopRequested.load(); ++n)
+    {
+        // one turn per 4 s, 10 m away
+        SharedMetadataRing::SourceFields fields {};
+        fields.index = 1;
+        fields.azimuth = (float)std::fmod(90.0 * (double)n / rate, 360.0);
+        fields.distance = 10.0f;
+        fields.volume = 0.1f;
+        writer.write(fields, nowMs());
+
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+        std::this_thread::sleep_until(next);
+    }
+
+    return 0;
+}
+
+struct FollowedRing
+{
+    std::string name;
+    SharedMetadataRing::Reader reader;
+    std::uint64_t records = 0;
+    double latencyMs = 0.0; // sum, time tag (or write time) to read
+    double nextOpenMs = 0.0;
+};
+
+static int runReader(const std::vector<std::string>& names, bool quiet)
+{
+    std::vector<std::unique_ptr<FollowedRing>> rings;
+
+    for (auto& name : names)
+    {
+        rings.push_back(std::make_unique<FollowedRing>());
+        rings.back()->name = name;
+    }
+
+    auto nextReport = nowMs() + 1000.0;
+
+    for (;;)
+    {
+        for (auto& ring : rings)
+        {
+            // not there yet, or the plugin was removed: (re)open, retried every 500 ms
+            if (! ring->reader.isOpen() || ring->reader.isWriterClosed())
+            {
+                if (nowMs() < ring->nextOpenMs)
+                    continue;
+
+                ring->nextOpenMs = nowMs() + 500.0;
+
+                if (! ring->reader.open(ring->name))
+                    continue;
+
+                std::printf("%s: following\n", ring->name.c_str());
+            }
+
+            // the callback only sees complete records: torn ones are counted as lost, never printed
+            ring->reader.poll([&](double timeMs, const SharedMetadataRing::SourceFields& f)
+                {
+                    ++ring->records;
+                    ring->latencyMs += timeMs > 0.0 ? nowMs() - timeMs : 0.0;
+
+                    if (! quiet)
+                        std::printf("/iosono/renderer/version1/src %d %d %.2f %.2f %.2f %.3f %g %g %d %d %g %d\n",
+                                    f.index, f.type, f.azimuth, f.elevation, f.distance, f.volume,
+                                    f.reserved0, f.reserved1, f.reserved2, f.reserved3, f.reserved4, f.reserved5);
+                });
+        }
+
+        if (nowMs() >= nextReport)
+        {
+            for (auto& ring : rings)
+            {
+                if (ring->reader.isOpen())
+                    std::printf("%s: %llu records/s, mean latency %.3f ms, lost %llu\n", ring->name.c_str(),
+                                (unsigned long long)ring->records, ring->records > 0 ? ring->latencyMs / (double)ring->records : 0.0,
+                                (unsigned long long)ring->reader.getLostCount());
+
+                ring->records = 0;
+                ring->latencyMs = 0.0;
+            }
+
+            std::fflush(stdout);
+            nextReport += 1000.0;
+        }
+
+        // a bridge would poll from its own loop (audio callback, MAX scheduler tick...). the sleep is not per record
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> names;
+    bool quiet = false;
+    bool write = false;
+    double rate = 500.0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+
+        if (arg == "--quiet")           quiet = true;
+        else if (arg == "--write")      write = true;
+        else if (write && ! names.empty() && std::atof(arg.c_str()) > 0.0)  rate = std::atof(arg.c_str());
+        else                            names.push_back(arg);
+    }
+
+    if (names.empty())
+        names.push_back("iosono-metadata-1");
+
+    return write ? runWriter(names.front(), rate) : runReader(names, quiet);
+}